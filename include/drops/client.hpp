@@ -0,0 +1,154 @@
+#pragma once
+
+#include <drops/tables.hpp>
+#include <optional>
+#include <vector>
+
+namespace dropssystem {
+
+// Read helpers for partner contracts, drops are verified by reading the `drop`, `lock` and `balances` tables of a
+// deployed drops contract directly (no inline actions, no RAM consumed by the partner contract).
+//
+// ```c++
+// #include <drops/client.hpp>
+//
+// const dropssystem::client drops("drops"_n);
+// check(drops.owns("alice"_n, seed), "Drop is not owned by alice.");
+// ```
+class client
+{
+public:
+   explicit client(const name code)
+      : code(code)
+      , _drops(code, code.value)
+      , _locks(code, code.value)
+      , _balances(code, code.value)
+   {
+   }
+
+   // whether the drops contract is deployed and enabled
+   bool is_enabled() const
+   {
+      const state_table state(code, code.value);
+      return state.exists() && state.get().enabled;
+   }
+
+   // drop of a seed (empty if it does not exist)
+   std::optional<drop_row> get(const uint64_t seed) const
+   {
+      const auto drop = _drops.find(seed);
+      if (drop == _drops.end()) {
+         return {};
+      }
+      return *drop;
+   }
+
+   bool exists(const uint64_t seed) const { return _drops.find(seed) != _drops.end(); }
+
+   bool owns(const name owner, const uint64_t seed) const
+   {
+      const auto drop = _drops.find(seed);
+      return drop != _drops.end() && drop->owner == owner;
+   }
+
+   bool is_bound(const uint64_t seed) const
+   {
+      const auto drop = _drops.find(seed);
+      return drop != _drops.end() && drop->bound;
+   }
+
+   bool is_locked(const uint64_t seed) const { return _locks.find(seed) != _locks.end(); }
+
+   // owned, unbound and unlocked (can be transferred or destroyed by the owner)
+   bool is_transferable(const name owner, const uint64_t seed) const
+   {
+      const auto drop = _drops.find(seed);
+      return drop != _drops.end() && drop->owner == owner && !drop->bound && !is_locked(seed);
+   }
+
+   // balance of an owner (empty if the balance is not open)
+   std::optional<balances_row> balance(const name owner) const
+   {
+      const auto balance = _balances.find(owner.value);
+      if (balance == _balances.end()) {
+         return {};
+      }
+      return *balance;
+   }
+
+   // amount of drops owned, read from the balance counters without walking the drops
+   int64_t count(const name owner) const
+   {
+      const auto balance = _balances.find(owner.value);
+      return balance == _balances.end() ? 0 : balance->drops;
+   }
+
+   // amount of bound, unbound & locked drops owned (0 until the balance is migrated, see `migrate`)
+   int64_t bound(const name owner) const { return counter(owner, &balances_row::bound); }
+   int64_t unbound(const name owner) const { return counter(owner, &balances_row::unbound); }
+   int64_t locked(const name owner) const { return counter(owner, &balances_row::locked); }
+
+   // batch verification, stops at the first seed not owned
+   bool owns_all(const name owner, const std::vector<uint64_t>& seeds) const
+   {
+      for (const uint64_t seed : seeds) {
+         if (!owns(owner, seed)) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   // batch verification, stops at the first seed that cannot be transferred
+   bool all_transferable(const name owner, const std::vector<uint64_t>& seeds) const
+   {
+      for (const uint64_t seed : seeds) {
+         if (!is_transferable(owner, seed)) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   // Walks the owner's drops in seed order starting from `cursor`, calling `fn(const drop_row&)` for at most `limit`
+   // drops. The rows are visited in place without copies, `fn` returns `false` to stop early.
+   // Returns the seed to resume from, empty once all of the owner's drops have been visited.
+   template <typename F>
+   std::optional<uint64_t>
+   for_each(const name owner, const uint32_t limit, const std::optional<uint64_t> cursor, F&& fn) const
+   {
+      const auto _drops_by_owner = _drops.get_index<"owner"_n>();
+
+      auto     itr     = _drops_by_owner.lower_bound(combine_ids(owner.value, cursor ? *cursor : 0));
+      uint32_t visited = 0;
+      while (itr != _drops_by_owner.end() && itr->owner == owner && visited < limit) {
+         visited++;
+         const bool next = fn(*itr);
+         itr++;
+         if (!next) {
+            break;
+         }
+      }
+
+      // Resume from the next drop of the owner (if any)
+      if (itr != _drops_by_owner.end() && itr->owner == owner) {
+         return itr->seed;
+      }
+      return {};
+   }
+
+   const name code;
+
+private:
+   int64_t counter(const name owner, binary_extension<int64_t> balances_row::*field) const
+   {
+      const auto balance = _balances.find(owner.value);
+      return balance == _balances.end() ? 0 : ((*balance).*field).value_or(0);
+   }
+
+   const drop_table     _drops;
+   const lock_table     _locks;
+   const balances_table _balances;
+};
+
+} // namespace dropssystem
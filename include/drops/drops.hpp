@@ -3,9 +3,11 @@
 #include <eosio.system/eosio.system.hpp>
 #include <eosio.token/eosio.token.hpp>
 #include <eosio/singleton.hpp>
+#include <set>
 
 #include <drops/drops.hpp>
 #include <drops/ram.hpp>
+#include <drops/tables.hpp>
 #include <drops/utils.hpp>
 
 using namespace eosio;
@@ -27,189 +29,992 @@ static const string ERROR_NO_DROPS           = "No drops were provided.";
 static const string MEMO_RAM_TRANSFER      = "Claiming RAM bytes.";
 static const string MEMO_RAM_SOLD_TRANSFER = "Claiming sold RAM bytes.";
 
+// maximum attempts to re-salt a colliding seed
+static const uint32_t MAX_RESALT_ATTEMPTS = 10;
+
+// maximum amount of quotes returned by `ramcurve`
+static const uint32_t MAX_RAMCURVE_QUOTES = 1000;
+
+// maximum amount of drops returned by read-only queries
+static const uint32_t MAX_READ_ONLY_DROPS = 10000;
+
+// maximum amount of journal slots beyond the capacity released per action
+static const uint32_t MAX_JOURNAL_TRIM = 100;
+
+// change types recorded in the `journal` table
+static const uint8_t CHANGE_MINT     = 0;
+static const uint8_t CHANGE_BURN     = 1;
+static const uint8_t CHANGE_TRANSFER = 2;
+static const uint8_t CHANGE_BIND     = 3;
+static const uint8_t CHANGE_UNBIND   = 4;
+static const uint8_t CHANGE_LOCK     = 5;
+static const uint8_t CHANGE_UNLOCK   = 6;
+
+// notification events of `subscription` (accounts without subscription are notified of all events)
+static const uint8_t NOTIFY_RAM_BYTES = 1 << 0; // logrambytes
+static const uint8_t NOTIFY_DROPS     = 1 << 1; // logdrops
+static const uint8_t NOTIFY_GENERATE  = 1 << 2; // loggenerate & drops generated for another account
+static const uint8_t NOTIFY_DESTROY   = 1 << 3; // logdestroy
+static const uint8_t NOTIFY_TRANSFER  = 1 << 4; // transfer, transfermany & batch transfers
+static const uint8_t NOTIFY_ALL       = (1 << 5) - 1;
+
+// packed drop flags returned by read-only queries
+static const uint8_t DROP_FLAG_BOUND  = 1 << 0;
+static const uint8_t DROP_FLAG_LOCKED = 1 << 1;
+
 // feature flags
 static const bool FLAG_FORCE_RECEIVER_TO_BE_SENDER = true;
 
 // not available until system contract supports `ramtransfer`
 static const bool FLAG_ENABLE_RAM_TRANSFER_ON_CLAIM = true;
 
-uint128_t combine_ids(const uint64_t& v1, const uint64_t& v2) { return (uint128_t{v1} << 64) | v2; }
+// close balances emptied of drops and RAM bytes, releasing their RAM to the payer
+#ifdef AUTO_CLOSE_BALANCES
+static const bool FLAG_AUTO_CLOSE_BALANCES = true;
+#else
+static const bool FLAG_AUTO_CLOSE_BALANCES = false;
+#endif
 
 class [[eosio::contract("drops")]] drops : public contract
 {
 public:
    using contract::contract;
+   ~drops();
+
+   /**
+    * ## TABLE `inventory`
+    *
+    * RAM inventory float, EOS deposits and withdrawals are credited against the float at the current market quote and
+    * the net position is settled with the system contract in batches.
+    *
+    * Credits use the spot price of the RAM market, which can be moved within a transaction before depositing. Each
+    * credit is capped at `max_pending` and the pending EOS is settled once it reaches `max_pending`, which bounds the
+    * position exposed to a manipulated price. Deposits above `max_pending` purchase RAM directly.
+    *
+    * ### params
+    *
+    * - `{bool} enabled` - whether the inventory mode is enabled
+    * - `{int64_t} bytes` - RAM bytes held by the contract as float
+    * - `{asset} pending` - EOS credited at the market quote and not yet settled
+    * - `{int64_t} min_bytes` - settle when the float falls below this amount of RAM bytes
+    * - `{asset} max_pending` - settle when the pending EOS reaches this quantity (maximum EOS credited per deposit)
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "enabled": true,
+    *   "bytes": 1048576,
+    *   "pending": "0.5000 EOS",
+    *   "min_bytes": 65536,
+    *   "max_pending": "10.0000 EOS"
+    * }
+    * ```
+    */
+   struct [[eosio::table("inventory")]] inventory_row
+   {
+      bool    enabled     = false;
+      int64_t bytes       = 0;
+      asset   pending     = asset{0, EOS};
+      int64_t min_bytes   = 0;
+      asset   max_pending = asset{0, EOS};
+   };
+
+   /**
+    * ## TABLE `migration`
+    *
+    * Progress of the balance being recounted by `migrate`.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner of the balance being recounted (contract for the global totals)
+    * - `{uint64_t} cursor` - seed to resume from
+    * - `{int64_t} bound` - amount of bound drops counted
+    * - `{int64_t} unbound` - amount of unbound drops counted
+    * - `{int64_t} locked` - amount of locked drops counted
+    * - `{uint64_t} checksum` - XOR of the seeds counted
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "owner": "test.gm",
+    *   "cursor": "7035598365496988505",
+    *   "bound": 9,
+    *   "unbound": 60,
+    *   "locked": 3,
+    *   "checksum": "7035598365496988505"
+    * }
+    * ```
+    */
+   struct [[eosio::table("migration")]] migration_row
+   {
+      name     owner;
+      uint64_t cursor  = 0;
+      int64_t  bound    = 0;
+      int64_t  unbound  = 0;
+      int64_t  locked   = 0;
+      uint64_t checksum = 0;
+   };
+
+   /**
+    * ## TABLE `journalstate`
+    *
+    * Slots beyond a reduced capacity are released in bounded steps by the following changes.
+    *
+    * ### params
+    *
+    * - `{uint64_t} capacity` - amount of changes kept in the `journal` ring buffer (0 = disabled)
+    * - `{uint64_t} next` - change number of the next recorded change
+    * - `{uint64_t} first` - first change number recorded with the current capacity
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "capacity": 10000,
+    *   "next": 123456,
+    *   "first": 100000
+    * }
+    * ```
+    */
+   struct [[eosio::table("journalstate")]] journal_state_row
+   {
+      uint64_t capacity = 0;
+      uint64_t next     = 0;
+      uint64_t first    = 0;
+   };
+
+   /**
+    * ## TABLE `journal`
+    *
+    * Ring buffer of drop changes, the slot of a change is its change number modulo the capacity.
+    *
+    * ### params
+    *
+    * - `{uint64_t} slot` - (primary key) slot in the ring buffer
+    * - `{uint64_t} change` - monotonic change number
+    * - `{uint64_t} seed` - seed of the changed drop
+    * - `{uint8_t} type` - change type (0 mint, 1 burn, 2 transfer, 3 bind, 4 unbind, 5 lock, 6 unlock)
+    * - `{name} owner` - owner of the drop after the change (owner before a burn)
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "slot": 3456,
+    *   "change": 123456,
+    *   "seed": "7035598365496988505",
+    *   "type": 2,
+    *   "owner": "test.gm"
+    * }
+    * ```
+    */
+   struct [[eosio::table("journal")]] journal_row
+   {
+      uint64_t slot;
+      uint64_t change;
+      uint64_t seed;
+      uint8_t  type;
+      name     owner;
+      uint64_t primary_key() const { return slot; }
+   };
+
+   /**
+    * ## TABLE `job`
+    *
+    * ### params
+    *
+    * - `{uint64_t} id` - (primary key) job id
+    * - `{name} owner` - owner of the generated drops
+    * - `{bool} bound` - whether the generated drops are bound
+    * - `{uint32_t} amount` - total amount of drops to generate
+    * - `{uint32_t} generated` - amount of drops generated so far
+    * - `{uint64_t} sequence` - first sequence of the range reserved for the job
+    * - `{string} data` - data used to generate the drop seeds
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "id": 0,
+    *   "owner": "test.gm",
+    *   "bound": false,
+    *   "amount": 1000000,
+    *   "generated": 5000,
+    *   "sequence": 100,
+    *   "data": "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    * }
+    * ```
+    */
+   struct [[eosio::table("job")]] job_row
+   {
+      uint64_t id;
+      name     owner;
+      bool     bound;
+      uint32_t amount;
+      uint32_t generated;
+      uint64_t sequence;
+      string   data;
+      uint64_t primary_key() const { return id; }
+   };
+
+   /**
+    * ## TABLE `reservation`
+    *
+    * ### params
+    *
+    * - `{name} owner` - (primary key) owner of the reserved sequence range
+    * - `{uint64_t} sequence` - next sequence of the reserved range
+    * - `{uint32_t} remaining` - amount of sequences remaining in the reserved range
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "owner": "test.gm",
+    *   "sequence": 100,
+    *   "remaining": 10
+    * }
+    * ```
+    */
+   struct [[eosio::table("reservation")]] reservation_row
+   {
+      name     owner;
+      uint64_t sequence;
+      uint32_t remaining;
+      uint64_t primary_key() const { return owner.value; }
+   };
+
+   /**
+    * ## TABLE `subscription`
+    *
+    * ### params
+    *
+    * - `{name} owner` - (primary key) subscribed account
+    * - `{uint8_t} events` - bitmask of notified events (1 RAM bytes, 2 drops, 4 generate, 8 destroy, 16 transfer)
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "owner": "test.gm",
+    *   "events": 16
+    * }
+    * ```
+    */
+   struct [[eosio::table("subscription")]] subscription_row
+   {
+      name     owner;
+      uint8_t  events;
+      uint64_t primary_key() const { return owner.value; }
+   };
+
+   /**
+    * ## TABLE `approval`
+    *
+    * ### params
+    *
+    * - `{uint64_t} id` - (primary key) approval id
+    * - `{name} owner` - owner account of the drops
+    * - `{name} approved` - account approved to transfer the owner's drops
+    * - `{uint64_t} remaining` - amount of drops the approved account may still transfer (0 = unlimited)
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "id": 0,
+    *   "owner": "test.gm",
+    *   "approved": "market.gm",
+    *   "remaining": 100
+    * }
+    * ```
+    */
+   struct [[eosio::table("approval")]] approval_row
+   {
+      uint64_t  id;
+      name      owner;
+      name      approved;
+      uint64_t  remaining;
+      uint64_t  primary_key() const { return id; }
+      uint128_t by_owner() const { return ((uint128_t)owner.value << 64) | approved.value; }
+   };
+
+   /**
+    * ## TABLE `shard`
+    *
+    * Seed partition of a sharded deployment, set by `setshard` (not sharded when empty).
+    *
+    * ### params
+    *
+    * - `{uint8_t} shard_bits` - amount of seed prefix bits identifying the shard (0 = not sharded)
+    * - `{uint8_t} shard` - seed prefix of the drops generated by this deployment
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "shard_bits": 2,
+    *   "shard": 1
+    * }
+    * ```
+    */
+   struct [[eosio::table("shard")]] shard_row
+   {
+      uint8_t shard_bits = 0; // seeds are partitioned across 2^shard_bits deployments
+      uint8_t shard      = 0; // seed prefix of this deployment
+   };
+
+   /**
+    * ## TABLE `route`
+    *
+    * Shard accounts of a sharded deployment, used by `shardof` to route actions.
+    *
+    * ### params
+    *
+    * - `{uint64_t} shard` - (primary key) seed prefix of the shard
+    * - `{name} account` - account where the shard is deployed
+    *
+    * ### example
+    *
+    * ```json
+    * {
+    *   "shard": 1,
+    *   "account": "drops1.gm"
+    * }
+    * ```
+    */
+   struct [[eosio::table("route")]] route_row
+   {
+      uint64_t shard;
+      name     account;
+      uint64_t primary_key() const { return shard; }
+   };
+
+   // `drop`, `lock`, `state` & `balances` tables are defined in drops/tables.hpp
+   typedef dropssystem::drop_row                                  drop_row;
+   typedef dropssystem::lock_row                                  lock_row;
+   typedef dropssystem::state_row                                 state_row;
+   typedef dropssystem::balances_row                              balances_row;
+   typedef dropssystem::drop_table                                drop_table;
+   typedef dropssystem::lock_table                                lock_table;
+   typedef dropssystem::state_table                               state_table;
+   typedef dropssystem::balances_table                            balances_table;
+   typedef eosio::singleton<"inventory"_n, inventory_row>         inventory_table;
+   typedef eosio::singleton<"migration"_n, migration_row>         migration_table;
+   typedef eosio::multi_index<"job"_n, job_row>                   job_table;
+   typedef eosio::multi_index<"reservation"_n, reservation_row>   reservation_table;
+   typedef eosio::multi_index<"subscription"_n, subscription_row> subscription_table;
+   typedef eosio::multi_index<
+      "approval"_n,
+      approval_row,
+      eosio::indexed_by<"owner"_n, eosio::const_mem_fun<approval_row, uint128_t, &approval_row::by_owner>>>
+                                                                  approval_table;
+   typedef eosio::singleton<"journalstate"_n, journal_state_row>  journal_state_table;
+   typedef eosio::multi_index<"journal"_n, journal_row>           journal_table;
+   typedef eosio::singleton<"shard"_n, shard_row>                 shard_table;
+   typedef eosio::multi_index<"route"_n, route_row>               route_table;
+
+   // @param
+   struct transfer_entry
+   {
+      name             to;
+      vector<uint64_t> droplet_ids;
+   };
+
+   // @param
+   struct transfer_from_entry
+   {
+      name             from;
+      name             to;
+      vector<uint64_t> droplet_ids;
+   };
+
+   // @param
+   struct airdrop_entry
+   {
+      name     to;
+      uint32_t amount;
+   };
+
+   // @param
+   struct batch_operation
+   {
+      name             action; // transfer, destroy, bind, unbind, lock or unlock
+      vector<uint64_t> droplet_ids;
+      optional<name>   to; // recipient of transfer operations
+   };
+
+   // @return
+   struct generate_return_value
+   {
+      int64_t bytes_used;
+      int64_t bytes_balance;
+   };
+
+   // @return
+   struct generatesafe_return_value
+   {
+      int64_t bytes_used;
+      int64_t bytes_balance;
+      int64_t generated;
+      int64_t collisions;
+   };
+
+   // @return
+   struct jobcontinue_return_value
+   {
+      int64_t generated;
+      int64_t remaining;
+   };
+
+   // @return
+   struct bytes_quote
+   {
+      int64_t bytes;
+      int64_t drops;
+      asset   cost;
+   };
+
+   // @return
+   struct quantity_quote
+   {
+      asset   quantity;
+      int64_t bytes;
+      int64_t drops;
+   };
+
+   // @return
+   struct ramcurve_return_value
+   {
+      vector<bytes_quote>    bytes;
+      vector<quantity_quote> quantities;
+   };
+
+   // @return
+   struct ownerdrops_return_value
+   {
+      vector<uint64_t>   seeds;
+      vector<uint8_t>    flags;
+      optional<uint64_t> next_cursor;
+   };
+
+   // @return
+   struct drop_info
+   {
+      uint64_t        seed;
+      name            owner;
+      bool            bound;
+      bool            locked;
+      block_timestamp created;
+   };
+
+   // @return
+   struct dropsinfo_return_value
+   {
+      vector<drop_info> drops;
+      vector<uint8_t>   valid;
+   };
+
+   // @return
+   struct simulate_return_value
+   {
+      uint64_t         sequence;
+      int64_t          bytes_required;
+      int64_t          bytes_balance;
+      int64_t          bytes_shortfall;
+      asset            shortfall_cost;
+      vector<uint64_t> seeds;
+      vector<uint64_t> collisions;
+   };
+
+   // @return
+   struct changes_return_value
+   {
+      vector<journal_row> changes;
+      uint64_t            next;
+      bool                behind;
+   };
+
+   // @return
+   struct shardof_return_value
+   {
+      vector<name> seeds;
+      name         owner;
+   };
+
+   // @return
+   struct checksum_return_value
+   {
+      int64_t  drops;
+      uint64_t checksum;
+   };
+
+   // @return
+   struct stats_return_value
+   {
+      balances_row balance;
+      balances_row totals;
+   };
+
+   // @return
+   struct destroy_return_value
+   {
+      int64_t unbound_destroyed;
+      int64_t bytes_reclaimed;
+   };
+
+   // @return
+   struct destroyall_return_value
+   {
+      int64_t            destroyed;
+      int64_t            unbound_destroyed;
+      int64_t            bytes_reclaimed;
+      optional<uint64_t> next_cursor;
+   };
+
+   // @return
+   struct sweep_return_value
+   {
+      int64_t        closed;
+      optional<name> next_cursor;
+   };
+
+   // @user
+   [[eosio::on_notify("*::transfer")]] int64_t
+   on_transfer(const name from, const name to, const asset quantity, const string memo);
+
+   // @user
+   [[eosio::on_notify("*::ramtransfer")]] void
+   on_ramtransfer(const name from, const name to, const int64_t bytes, const string memo);
+
+   // @user
+   [[eosio::action]] generate_return_value generate(const name             owner,
+                                                    const bool             bound,
+                                                    const uint32_t         amount,
+                                                    const string           data,
+                                                    const optional<name>   to_notify,
+                                                    const optional<string> memo);
+
+   /**
+    * ## ACTION `generatesafe`
+    *
+    * - **authority**: `owner`
+    *
+    * Generates drops like `generate`, checking every seed for collisions instead of only the first one.
+    * Colliding drops are either re-salted with a new seed (`resalt`) or skipped and their RAM bytes refunded (`skip`),
+    * so the batch never aborts on a collision. The amount of collisions is reported in the return value.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner of the generated drops
+    * - `{bool} bound` - whether the generated drops are bound
+    * - `{uint32_t} amount` - amount of drops to generate
+    * - `{string} data` - data used to generate the drop seeds (at least 32 characters)
+    * - `{name} on_collision` - collision mode (`resalt` or `skip`)
+    * - `{name} [to_notify]` - account to notify
+    * - `{string} [memo]` - memo attached to the generate log
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops generatesafe '["alice", false, 1000, "<data>", "skip", null, null]' -p alice
+    * ```
+    */
+   [[eosio::action]] generatesafe_return_value generatesafe(const name             owner,
+                                                            const bool             bound,
+                                                            const uint32_t         amount,
+                                                            const string           data,
+                                                            const name             on_collision,
+                                                            const optional<name>   to_notify,
+                                                            const optional<string> memo);
+
+   /**
+    * ## ACTION `generateopts`
+    *
+    * - **authority**: `owner`
+    *
+    * Generates drops like `generate`, applying their final state when they are emplaced.
+    * Drops can be locked and/or generated for a recipient, instead of following the mint with `lock` or `transfer`.
+    * RAM bytes of the unbound drops and of the lock rows are paid by the owner.
+    *
+    * ### params
+    *
+    * - `{name} owner` - account generating the drops
+    * - `{bool} bound` - whether the generated drops are bound (recipient must be the owner)
+    * - `{uint32_t} amount` - amount of drops to generate
+    * - `{string} data` - data used to generate the drop seeds (at least 32 characters)
+    * - `{bool} locked` - whether the generated drops are locked
+    * - `{name} [to]` - recipient of the generated drops (defaults to owner)
+    * - `{name} [to_notify]` - account to notify
+    * - `{string} [memo]` - memo attached to the generate log
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops generateopts '["alice", false, 100, "<data>", true, "bob", null, null]' -p alice
+    * ```
+    */
+   [[eosio::action]] generate_return_value generateopts(const name             owner,
+                                                        const bool             bound,
+                                                        const uint32_t         amount,
+                                                        const string           data,
+                                                        const bool             locked,
+                                                        const optional<name>   to,
+                                                        const optional<name>   to_notify,
+                                                        const optional<string> memo);
+
+   /**
+    * ## ACTION `jobcreate`
+    *
+    * - **authority**: `owner`
+    *
+    * Creates a generation job for mints larger than a single transaction.
+    * RAM bytes of unbound drops and the sequence range are reserved up front, drops are generated with `jobcontinue`.
+    * Returns the job id.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner of the generated drops
+    * - `{bool} bound` - whether the generated drops are bound
+    * - `{uint32_t} amount` - total amount of drops to generate
+    * - `{string} data` - data used to generate the drop seeds (at least 32 characters)
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops jobcreate '["alice", false, 1000000, "<data>"]' -p alice
+    * ```
+    */
+   [[eosio::action]] uint64_t jobcreate(const name owner, const bool bound, const uint32_t amount, const string data);
+
+   /**
+    * ## ACTION `jobcontinue`
+    *
+    * - **authority**: `owner`
+    *
+    * Generates the next chunk of at most `max_amount` drops of a job. The job is removed once completed.
+    * Seeds are identical to the ones a single `generate` of the whole amount would have produced.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner of the job
+    * - `{uint64_t} job_id` - job id
+    * - `{uint32_t} max_amount` - maximum amount of drops to generate
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops jobcontinue '["alice", 0, 1000]' -p alice
+    * ```
+    */
+   [[eosio::action]] jobcontinue_return_value
+   jobcontinue(const name owner, const uint64_t job_id, const uint32_t max_amount);
+
+   /**
+    * ## ACTION `jobcancel`
+    *
+    * - **authority**: `owner`
+    *
+    * Cancels a job and returns the reserved RAM bytes of the drops that were not generated.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner of the job
+    * - `{uint64_t} job_id` - job id
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops jobcancel '["alice", 0]' -p alice
+    * ```
+    */
+   [[eosio::action]] int64_t jobcancel(const name owner, const uint64_t job_id);
+
+   /**
+    * ## ACTION `airdrop`
+    *
+    * - **authority**: `owner`
+    *
+    * Generates unbound drops directly into the balances of many recipients.
+    * Each drop is emplaced once with its final owner, each recipient balance is updated once per recipient.
+    * RAM bytes are consumed from the `owner` balance.
+    *
+    * ### params
+    *
+    * - `{name} owner` - account paying for the generated drops
+    * - `{vector<airdrop_entry>} recipients` - list of recipients and the amount of drops they receive
+    * - `{string} data` - data used to generate the drop seeds (at least 32 characters)
+    * - `{name} [to_notify]` - account to notify
+    * - `{string} [memo]` - memo attached to the generate log
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops airdrop '["alice", [{"to": "bob", "amount": 10}], "<data>", null, null]' -p alice
+    * ```
+    */
+   [[eosio::action]] generate_return_value airdrop(const name                  owner,
+                                                   const vector<airdrop_entry> recipients,
+                                                   const string                data,
+                                                   const optional<name>        to_notify,
+                                                   const optional<string>      memo);
+
+   // @user
+   [[eosio::action]] void
+   transfer(const name from, const name to, const vector<uint64_t> droplet_ids, const optional<string> memo);
+
+   /**
+    * ## ACTION `transfermany`
+    *
+    * - **authority**: `from`
+    *
+    * Transfers drops to many recipients in a single action.
+    * Sender balance is updated once and each recipient balance is updated once per recipient (not per entry).
+    *
+    * ### params
+    *
+    * - `{name} from` - sender account
+    * - `{vector<transfer_entry>} transfers` - list of recipients and the drops they receive
+    * - `{string} [memo]` - memo attached to the transfer
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops transfermany '["alice", [{"to": "bob", "droplet_ids": [123]}], null]' -p alice
+    * ```
+    */
+   [[eosio::action]] void
+   transfermany(const name from, const vector<transfer_entry> transfers, const optional<string> memo);
+
+   /**
+    * ## ACTION `approve`
+    *
+    * - **authority**: `owner`
+    *
+    * Approves an account to transfer the owner's drops with `transferfrom`.
+    * Approving an already approved account replaces its limit.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner account of the drops
+    * - `{name} approved` - approved account (ex: marketplace contract)
+    * - `{uint64_t} [limit]` - amount of drops the approved account may transfer (unlimited if empty)
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops approve '["alice", "market.gm", 100]' -p alice
+    * ```
+    */
+   [[eosio::action]] void approve(const name owner, const name approved, const optional<uint64_t> limit);
+
+   /**
+    * ## ACTION `unapprove`
+    *
+    * - **authority**: `owner`
+    *
+    * Revokes the approval of an account to transfer the owner's drops.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner account of the drops
+    * - `{name} approved` - approved account
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops unapprove '["alice", "market.gm"]' -p alice
+    * ```
+    */
+   [[eosio::action]] void unapprove(const name owner, const name approved);
+
+   /**
+    * ## ACTION `transferfrom`
+    *
+    * - **authority**: `approved`
+    *
+    * Transfers drops of many owners in a single action on behalf of an approved account.
+    * Each owner's approval is checked and consumed once for all of its drops, and each balance is updated once.
+    * The approved account pays for the balances opened for new recipients.
+    *
+    * ### params
+    *
+    * - `{name} approved` - approved account settling the transfers
+    * - `{vector<transfer_from_entry>} transfers` - list of owners, recipients and the drops they receive
+    * - `{string} [memo]` - memo attached to the transfer
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops transferfrom \
+    *   '["market.gm", [{"from": "alice", "to": "bob", "droplet_ids": [123]}], null]' -p market.gm
+    * ```
+    */
+   [[eosio::action]] void
+   transferfrom(const name approved, const vector<transfer_from_entry> transfers, const optional<string> memo);
+
+   // @user
+   [[eosio::action]] destroy_return_value destroy(const name             owner,
+                                                  const vector<uint64_t> droplet_ids,
+                                                  const optional<string> memo,
+                                                  const optional<name>   to_notify);
+
+   /**
+    * ## ACTION `destroyclaim`
+    *
+    * - **authority**: `owner`
+    *
+    * Destroys drops and sends the reclaimed RAM bytes directly to the receiver in the same action,
+    * instead of crediting them to the owner balance to be claimed later.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner account of the drops
+    * - `{vector<uint64_t>} droplet_ids` - drops to destroy
+    * - `{name} [receiver]` - receiver of the reclaimed RAM bytes (defaults to owner)
+    * - `{string} [memo]` - memo attached to the destroy log
+    * - `{name} [to_notify]` - account to notify
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops destroyclaim '["alice", [123], null, null, null]' -p alice
+    * ```
+    */
+   [[eosio::action]] destroy_return_value destroyclaim(const name             owner,
+                                                       const vector<uint64_t> droplet_ids,
+                                                       const optional<name>   receiver,
+                                                       const optional<string> memo,
+                                                       const optional<name>   to_notify);
+
+   /**
+    * ## ACTION `destroyall`
+    *
+    * - **authority**: `owner`
+    *
+    * Destroys the owner's drops in seed order, starting from `cursor` and visiting at most `limit` drops.
+    * Locked drops are skipped. Reclaimed RAM bytes are credited to the owner the same way as `destroy`.
+    * Returns `next_cursor` to resume from, which is empty once all of the owner's drops have been visited.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner account of the drops
+    * - `{uint32_t} limit` - maximum amount of drops to visit
+    * - `{uint64_t} [cursor]` - seed to resume from (inclusive)
+    * - `{string} [memo]` - memo attached to the destroy log
+    * - `{name} [to_notify]` - account to notify
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops destroyall '["alice", 500, null, null, null]' -p alice
+    * ```
+    */
+   [[eosio::action]] destroyall_return_value destroyall(const name               owner,
+                                                        const uint32_t           limit,
+                                                        const optional<uint64_t> cursor,
+                                                        const optional<string>   memo,
+                                                        const optional<name>     to_notify);
+
+   // @user
+   [[eosio::action]] int64_t bind(const name owner, const vector<uint64_t> droplet_ids);
+
+   // @user
+   [[eosio::action]] int64_t unbind(const name owner, const vector<uint64_t> droplet_ids);
+
+   // @user
+   [[eosio::action]] void lock(const name owner, const vector<uint64_t> droplet_ids);
+
+   // @user
+   [[eosio::action]] void unlock(const name owner, const vector<uint64_t> droplet_ids);
 
    /**
-    * ## TABLE `drops`
+    * ## ACTION `batch`
+    *
+    * - **authority**: `owner`
+    *
+    * Executes an ordered list of operations on the owner's drops in a single action.
+    * Supported operations are `transfer`, `destroy`, `bind`, `unbind`, `lock` and `unlock`.
+    * Balances and logs are updated once at the end of the batch, returns the net RAM bytes change of the owner.
     *
     * ### params
     *
-    * - `{uint64_t} seed` - (primary key) unique seed
-    * - `{name} owner` - owner of the drop
-    * - `{block_timestamp} created` - creation time
-    * - `{bool} bound` - whether the drop is bound to an account
+    * - `{name} owner` - owner account of the drops
+    * - `{vector<batch_operation>} operations` - list of operations to execute
+    * - `{string} [memo]` - memo attached to the destroy log
     *
     * ### example
     *
-    * ```json
-    * {
-    *   "seed": 16355392114041409,
-    *   "owner": "test.gm",
-    *   "created": "2024-01-29T00:00:00.000",
-    *   "bound": false
-    * }
+    * ```bash
+    * $ cleos push action core.drops batch '["alice", [{"action": "lock", "droplet_ids": [123]}], null]' -p alice
     * ```
     */
-   struct [[eosio::table("drop")]] drop_row
-   {
-      uint64_t        seed;
-      name            owner;
-      block_timestamp created;
-      bool            bound;
-      uint64_t        primary_key() const { return seed; }
-      uint128_t       by_owner() const { return ((uint128_t)owner.value << 64) | seed; }
-   };
+   [[eosio::action]] int64_t
+   batch(const name owner, const vector<batch_operation> operations, const optional<string> memo);
 
    /**
-    * ## TABLE `lock`
+    * ## ACTION `reserve`
+    *
+    * - **authority**: `owner`
+    *
+    * Reserves a private sequence range for the owner and returns its first sequence.
+    * Subsequent generations of the owner use the reserved range, which makes their seeds known ahead of time.
+    * Generations larger than the remaining range use the global sequence and leave the range untouched.
     *
     * ### params
     *
-    * - `{uint64_t} seed` - (primary key) unique seed
+    * - `{name} owner` - owner account of the reserved range
+    * - `{uint32_t} amount` - amount of sequences to reserve
     *
     * ### example
     *
-    * ```json
-    * {
-    *   "seed": 16355392114041409,
-    * }
+    * ```bash
+    * $ cleos push action core.drops reserve '["alice", 100]' -p alice
     * ```
     */
-   struct [[eosio::table("lock")]] lock_row
-   {
-      uint64_t seed;
-      uint64_t primary_key() const { return seed; }
-   };
+   [[eosio::action]] uint64_t reserve(const name owner, const uint32_t amount);
 
    /**
-    * ## TABLE `state`
+    * ## ACTION `unreserve`
+    *
+    * - **authority**: `owner`
+    *
+    * Releases the remaining sequence range reserved by the owner.
     *
     * ### params
     *
-    * - `{block_timestamp} genesis` - genesis time when the contract was created
-    * - `{int64_t} bytes_per_drop` - amount of RAM bytes required per minting drop
-    * - `{uint64_t} sequence` - sequence is used as a salt to add an extra layer of complexity and randomness to the
-    * hashing process.
-    * - `{bool} enabled` - whether the contract is enabled
+    * - `{name} owner` - owner account of the reserved range
     *
     * ### example
     *
-    * ```json
-    * {
-    *   "genesis": "2024-01-29T00:00:00",
-    *   "bytes_per_drop": 277,
-    *   "sequence": 0,
-    *   "enabled": true
-    * }
+    * ```bash
+    * $ cleos push action core.drops unreserve '["alice"]' -p alice
     * ```
     */
-   struct [[eosio::table("state")]] state_row
-   {
-      block_timestamp genesis        = current_block_time();
-      int64_t         bytes_per_drop = 277; // 133 bytes primary row + 144 bytes secondary row
-      uint64_t        sequence       = 0;   // auto-incremented on each drop generation
-      bool            enabled        = true;
-   };
+   [[eosio::action]] void unreserve(const name owner);
 
    /**
-    * ## TABLE `balances`
+    * ## ACTION `subscribe`
+    *
+    * - **authority**: `owner`
+    *
+    * Sets the events the owner is notified about, unsubscribed events do not notify the owner.
+    * Subscribing to all events removes the subscription, which is the default for every account.
     *
     * ### params
     *
-    * - `{name} owner` - (primary key) owner account
-    * - `{int64_t} drops` - total amount of drops owned
-    * - `{int64_t} ram_bytes` - total amount of RAM bytes available by the owner
+    * - `{name} owner` - subscribed account
+    * - `{uint8_t} events` - bitmask of notified events (1 RAM bytes, 2 drops, 4 generate, 8 destroy, 16 transfer)
     *
     * ### example
     *
-    * ```json
-    * {
-    *   "owner": "test.gm",
-    *   "drops": 69,
-    *   "ram_bytes": 2048
-    * }
+    * ```bash
+    * $ cleos push action core.drops subscribe '["alice", 16]' -p alice
     * ```
     */
-   struct [[eosio::table("balances")]] balances_row
-   {
-      name    owner;
-      int64_t drops;
-      int64_t ram_bytes;
-
-      uint64_t primary_key() const { return owner.value; }
-   };
-
-   typedef eosio::multi_index<
-      "drop"_n,
-      drop_row,
-      eosio::indexed_by<"owner"_n, eosio::const_mem_fun<drop_row, uint128_t, &drop_row::by_owner>>>
-                                                          drop_table;
-   typedef eosio::singleton<"state"_n, state_row>         state_table;
-   typedef eosio::multi_index<"balances"_n, balances_row> balances_table;
-   typedef eosio::multi_index<"lock"_n, lock_row>         lock_table;
-
-   // @return
-   struct generate_return_value
-   {
-      int64_t bytes_used;
-      int64_t bytes_balance;
-   };
-
-   // @return
-   struct destroy_return_value
-   {
-      int64_t unbound_destroyed;
-      int64_t bytes_reclaimed;
-   };
-
-   // @user
-   [[eosio::on_notify("*::transfer")]] int64_t
-   on_transfer(const name from, const name to, const asset quantity, const string memo);
-
-   // @user
-   [[eosio::on_notify("*::ramtransfer")]] void
-   on_ramtransfer(const name from, const name to, const int64_t bytes, const string memo);
-
-   // @user
-   [[eosio::action]] generate_return_value generate(const name             owner,
-                                                    const bool             bound,
-                                                    const uint32_t         amount,
-                                                    const string           data,
-                                                    const optional<name>   to_notify,
-                                                    const optional<string> memo);
-
-   // @user
-   [[eosio::action]] void
-   transfer(const name from, const name to, const vector<uint64_t> droplet_ids, const optional<string> memo);
-
-   // @user
-   [[eosio::action]] destroy_return_value destroy(const name             owner,
-                                                  const vector<uint64_t> droplet_ids,
-                                                  const optional<string> memo,
-                                                  const optional<name>   to_notify);
-
-   // @user
-   [[eosio::action]] int64_t bind(const name owner, const vector<uint64_t> droplet_ids);
-
-   // @user
-   [[eosio::action]] int64_t unbind(const name owner, const vector<uint64_t> droplet_ids);
-
-   // @user
-   [[eosio::action]] void lock(const name owner, const vector<uint64_t> droplet_ids);
-
-   // @user
-   [[eosio::action]] void unlock(const name owner, const vector<uint64_t> droplet_ids);
+   [[eosio::action]] void subscribe(const name owner, const uint8_t events);
 
    /**
     * ## ACTION `open`
@@ -232,6 +1037,26 @@ public:
     */
    [[eosio::action]] bool open(const name owner);
 
+   /**
+    * ## ACTION `close`
+    *
+    * - **authority**: `owner`
+    *
+    * Closes the balances table row of owner account, releasing its RAM to the account that opened it.
+    * Balance must not hold any drops or RAM bytes.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner account to close balances
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops close '["alice"]' -p alice
+    * ```
+    */
+   [[eosio::action]] void close(const name owner);
+
    /**
     * ## ACTION `claim`
     *
@@ -256,9 +1081,238 @@ public:
    [[eosio::action, eosio::read_only]] asset   ramcost(const int64_t bytes);
    [[eosio::action, eosio::read_only]] int64_t bytescost(const asset quantity);
 
+   /**
+    * ## ACTION `ramcurve`
+    *
+    * - **authority**: `any`
+    *
+    * Returns RAM quotes for many amounts, the RAM market is read once.
+    * Byte amounts are quoted with their EOS cost (fee included) and EOS quantities with the bytes they purchase
+    * (fee deducted), both with the amount of drops covered by the bytes.
+    *
+    * ### params
+    *
+    * - `{vector<int64_t>} bytes` - RAM bytes amounts to quote
+    * - `{vector<asset>} quantities` - EOS quantities to quote
+    * - `{int64_t} from` - first RAM bytes amount of the range (ignored if `step` is 0)
+    * - `{int64_t} to` - last RAM bytes amount of the range (inclusive)
+    * - `{int64_t} step` - RAM bytes between amounts of the range
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops ramcurve '[[277], ["1.0000 EOS"], 1000, 10000, 1000]' -p alice
+    * ```
+    */
+   [[eosio::action, eosio::read_only]] ramcurve_return_value ramcurve(const vector<int64_t> bytes,
+                                                                      const vector<asset>   quantities,
+                                                                      const int64_t         from,
+                                                                      const int64_t         to,
+                                                                      const int64_t         step);
+
+   /**
+    * ## ACTION `ownerdrops`
+    *
+    * - **authority**: `any`
+    *
+    * Returns the drops of an owner in packed form, walking the `owner` index from the cursor up to the limit.
+    * Each seed has its flags at the same position (`1` bound, `2` locked).
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner of the drops
+    * - `{uint32_t} limit` - maximum amount of drops to return
+    * - `{uint64_t} [cursor]` - seed to resume from (returned as `next_cursor`)
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops ownerdrops '["alice", 1000, null]' -p alice
+    * ```
+    */
+   [[eosio::action, eosio::read_only]] ownerdrops_return_value
+   ownerdrops(const name owner, const uint32_t limit, const optional<uint64_t> cursor);
+
+   /**
+    * ## ACTION `dropsinfo`
+    *
+    * - **authority**: `any`
+    *
+    * Returns the owner, bound, locked and created values of many drops in one call.
+    * The validity bitmap has bit `i % 8` of byte `i / 8` set when drop `i` exists, belongs to the expected owner (if
+    * any) and is transferable (unbound and unlocked). Drops that do not exist are returned with an empty owner.
+    *
+    * ### params
+    *
+    * - `{vector<uint64_t>} droplet_ids` - seeds of the drops
+    * - `{name} [owner]` - expected owner of the drops
+    * - `{bool} [compact]` - only return the validity bitmap
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops dropsinfo '[[123, 456], "alice", false]' -p alice
+    * ```
+    */
+   [[eosio::action, eosio::read_only]] dropsinfo_return_value
+   dropsinfo(const vector<uint64_t> droplet_ids, const optional<name> owner, const optional<bool> compact);
+
+   /**
+    * ## ACTION `simulate`
+    *
+    * - **authority**: `any`
+    *
+    * Simulates `generate` without modifying any state, using the sequence range reserved by the owner (if any).
+    * Returns the RAM bytes required, the owner's RAM bytes balance, the shortfall and its EOS cost (fee included) at
+    * the current market price, the first predicted seeds and the predicted seeds that already exist.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner of the generated drops
+    * - `{bool} bound` - whether the generated drops are bound
+    * - `{uint32_t} amount` - amount of drops to generate
+    * - `{string} data` - data used to generate the drop seeds (at least 32 characters)
+    * - `{uint32_t} preview` - amount of predicted seeds to return and check for collisions
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops simulate '["alice", false, 1000, "<data>", 10]' -p alice
+    * ```
+    */
+   [[eosio::action, eosio::read_only]] simulate_return_value
+   simulate(const name owner, const bool bound, const uint32_t amount, const string data, const uint32_t preview);
+
+   /**
+    * ## ACTION `changes`
+    *
+    * - **authority**: `any`
+    *
+    * Returns the recorded drop changes starting from a change number, up to the limit.
+    * `next` is the change number to resume from. `behind` is true when changes since the requested number were
+    * already overwritten in the ring buffer, the client must then rescan the `drop` table.
+    *
+    * ### params
+    *
+    * - `{uint64_t} since` - first change number to return
+    * - `{uint32_t} limit` - maximum amount of changes to return
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops changes '[123000, 1000]' -p alice
+    * ```
+    */
+   [[eosio::action, eosio::read_only]] changes_return_value changes(const uint64_t since, const uint32_t limit);
+
+   /**
+    * ## ACTION `checksum`
+    *
+    * - **authority**: `any`
+    *
+    * Returns the amount of drops of an owner with the XOR of their seeds.
+    * The checksum does not depend on the order of the seeds, replicas can verify an owner's whole inventory with it.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner account
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops checksum '["alice"]' -p alice
+    * ```
+    */
+   [[eosio::action, eosio::read_only]] checksum_return_value checksum(const name owner);
+
+   /**
+    * ## ACTION `shardof`
+    *
+    * - **authority**: `any`
+    *
+    * Routes actions of a sharded deployment, returns the shard account holding each seed (`transfer`, `destroy`,
+    * `bind`...) and the shard account where the owner generates drops. Unknown shards are returned as an empty name.
+    *
+    * ### params
+    *
+    * - `{vector<uint64_t>} seeds` - seeds to route
+    * - `{name} owner` - owner account generating drops
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops shardof '[[123], "alice"]' -p alice
+    * ```
+    */
+   [[eosio::action, eosio::read_only]] shardof_return_value shardof(const vector<uint64_t> seeds, const name owner);
+
+   /**
+    * ## ACTION `stats`
+    *
+    * - **authority**: `any`
+    *
+    * Returns the balance of an owner (drops, RAM bytes, bound, unbound & locked counters) with the global totals.
+    *
+    * ### params
+    *
+    * - `{name} owner` - owner account
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops stats '["alice"]' -p alice
+    * ```
+    */
+   [[eosio::action, eosio::read_only]] stats_return_value stats(const name owner);
+
+   /**
+    * ## ACTION `settle`
+    *
+    * - **authority**: `any`
+    *
+    * Settles the pending EOS of the RAM inventory with the system contract by purchasing RAM bytes into the float.
+    * Returns the amount of RAM bytes purchased.
+    *
+    * ### example
+    *
+    * ```bash
+    * $ cleos push action core.drops settle '[]' -p alice
+    * ```
+    */
+   [[eosio::action]] int64_t settle();
+
    // @admin
    [[eosio::action]] void enable(bool enabled);
 
+   // @admin
+   // NOTE: credits are priced at the spot RAM market, keep `max_pending` low to bound the exposure to manipulation
+   [[eosio::action]] void setinventory(const bool enabled, const int64_t min_bytes, const asset max_pending);
+
+   // @admin
+   // NOTE: bytes must already be held by the contract and not used by its rows, this is not verified on chain (the
+   // RAM usage of the contract is only readable with the privileged `get_resource_limits`)
+   [[eosio::action]] void addinventory(const int64_t bytes);
+
+   // @admin
+   // NOTE: slots beyond a reduced capacity are released in bounded steps by each change (or by calling it again)
+   [[eosio::action]] void setjournal(const uint64_t capacity);
+
+   // @admin
+   [[eosio::action]] void setshard(const uint8_t shard_bits, const uint8_t shard);
+
+   // @admin
+   [[eosio::action]] void setroute(const uint8_t shard, const optional<name> account);
+
+   // @admin
+   // NOTE: recounts the counters and checksum of a balance in steps of `limit` drops, returns true once migrated
+   // NOTE: upgrade with the system disabled and migrate every balance (including the contract) before enabling it
+   [[eosio::action]] bool migrate(const name owner, const uint32_t limit);
+
+   // @admin
+   // NOTE: closes empty balances from `cursor` visiting at most `limit` rows, balances opened by their owner ahead of a
+   // deposit are empty as well (anyone could otherwise close them)
+   [[eosio::action]] sweep_return_value sweep(const uint32_t limit, const optional<name> cursor);
+
    // @logging
    [[eosio::action]] void
    logrambytes(const name owner, const int64_t bytes, const int64_t before_ram_bytes, const int64_t ram_bytes);
@@ -298,15 +1352,40 @@ public:
    // @static
    static void check_is_enabled(const name code) { check(is_enabled(code), ERROR_SYSTEM_DISABLED); }
 
+   // @static
+   static uint8_t seed_shard(const uint64_t seed, const uint8_t shard_bits)
+   {
+      return shard_bits ? seed >> (64 - shard_bits) : 0;
+   }
+
    // action wrappers
-   using generate_action = eosio::action_wrapper<"generate"_n, &drops::generate>;
-   using transfer_action = eosio::action_wrapper<"transfer"_n, &drops::transfer>;
-   using destroy_action  = eosio::action_wrapper<"destroy"_n, &drops::destroy>;
-   using bind_action     = eosio::action_wrapper<"bind"_n, &drops::bind>;
-   using unbind_action   = eosio::action_wrapper<"unbind"_n, &drops::unbind>;
-   using enable_action   = eosio::action_wrapper<"enable"_n, &drops::enable>;
-   using open_action     = eosio::action_wrapper<"open"_n, &drops::open>;
-   using claim_action    = eosio::action_wrapper<"claim"_n, &drops::claim>;
+   using generate_action     = eosio::action_wrapper<"generate"_n, &drops::generate>;
+   using generatesafe_action = eosio::action_wrapper<"generatesafe"_n, &drops::generatesafe>;
+   using generateopts_action = eosio::action_wrapper<"generateopts"_n, &drops::generateopts>;
+   using jobcreate_action    = eosio::action_wrapper<"jobcreate"_n, &drops::jobcreate>;
+   using jobcontinue_action  = eosio::action_wrapper<"jobcontinue"_n, &drops::jobcontinue>;
+   using jobcancel_action    = eosio::action_wrapper<"jobcancel"_n, &drops::jobcancel>;
+   using airdrop_action      = eosio::action_wrapper<"airdrop"_n, &drops::airdrop>;
+   using transfer_action     = eosio::action_wrapper<"transfer"_n, &drops::transfer>;
+   using transfermany_action = eosio::action_wrapper<"transfermany"_n, &drops::transfermany>;
+   using approve_action      = eosio::action_wrapper<"approve"_n, &drops::approve>;
+   using unapprove_action    = eosio::action_wrapper<"unapprove"_n, &drops::unapprove>;
+   using transferfrom_action = eosio::action_wrapper<"transferfrom"_n, &drops::transferfrom>;
+   using destroy_action      = eosio::action_wrapper<"destroy"_n, &drops::destroy>;
+   using destroyclaim_action = eosio::action_wrapper<"destroyclaim"_n, &drops::destroyclaim>;
+   using destroyall_action   = eosio::action_wrapper<"destroyall"_n, &drops::destroyall>;
+   using bind_action         = eosio::action_wrapper<"bind"_n, &drops::bind>;
+   using unbind_action       = eosio::action_wrapper<"unbind"_n, &drops::unbind>;
+   using batch_action        = eosio::action_wrapper<"batch"_n, &drops::batch>;
+   using reserve_action      = eosio::action_wrapper<"reserve"_n, &drops::reserve>;
+   using unreserve_action    = eosio::action_wrapper<"unreserve"_n, &drops::unreserve>;
+   using subscribe_action    = eosio::action_wrapper<"subscribe"_n, &drops::subscribe>;
+   using settle_action       = eosio::action_wrapper<"settle"_n, &drops::settle>;
+   using enable_action       = eosio::action_wrapper<"enable"_n, &drops::enable>;
+   using open_action         = eosio::action_wrapper<"open"_n, &drops::open>;
+   using close_action        = eosio::action_wrapper<"close"_n, &drops::close>;
+   using sweep_action        = eosio::action_wrapper<"sweep"_n, &drops::sweep>;
+   using claim_action        = eosio::action_wrapper<"claim"_n, &drops::claim>;
 
    using logrambytes_action = eosio::action_wrapper<"logrambytes"_n, &drops::logrambytes>;
    using logdrops_action    = eosio::action_wrapper<"logdrops"_n, &drops::logdrops>;
@@ -325,17 +1404,34 @@ public:
 private:
    int64_t  get_bytes_per_drop();
    uint64_t hash_data(const string data);
+   uint64_t generate_seed(const uint32_t index, const uint64_t sequence, const string& data);
+   uint64_t resalt_seed(const drop_table& _drops, const uint64_t seed);
 
    // helpers
    void transfer_tokens(const name to, const asset quantity, const string memo);
    void transfer_ram(const name to, const int64_t bytes, const string memo);
+   void withdraw_ram_bytes(const name to, const int64_t bytes);
    void buy_ram_bytes(int64_t bytes);
    void sell_ram_bytes(int64_t bytes);
    void buy_ram(const asset quantity);
    void notify(const optional<name> to_notify);
+   void notify(const name account, const uint8_t event);
+   void deposit_ram_bytes(const name from, const string memo, const int64_t bytes);
    void check_drop_locked(const drop_row drop);
    void modify_locked(const uint64_t drop_id, const name owner, const bool locked);
 
+   // journal helpers
+   void record_changes(const uint8_t type, const vector<uint64_t>& seeds, const name owner);
+   void record_changes(const uint8_t type, const vector<drop_row>& drops);
+   void record_change(journal_state_row& state, journal_table& _journal, const uint8_t type, const uint64_t seed,
+                      const name owner);
+   void trim_journal(const journal_state_row& state, journal_table& _journal);
+
+   // RAM inventory helpers
+   bool    credit_inventory(const eosiosystem::ram_quote& quote, const asset quantity, const int64_t bytes);
+   bool    debit_inventory(const int64_t bytes, const asset quantity);
+   int64_t settle_inventory(const eosiosystem::ram_quote& quote, inventory_row& inventory);
+
    // ram balances helpers
    int64_t update_ram_bytes(const name owner, const int64_t bytes);
    int64_t add_ram_bytes(const name owner, const int64_t bytes);
@@ -344,10 +1440,27 @@ private:
    int64_t get_ram_bytes(const name owner);
 
    // drop balances helpers
-   void update_drops(const name from, const name to, const int64_t amount);
-   void add_drops(const name owner, const int64_t amount);
-   void reduce_drops(const name owner, const int64_t amount);
-   void transfer_drops(const name from, const name to, const int64_t amount);
+   void     update_drops(const name     from,
+                         const name     to,
+                         const int64_t  bound,
+                         const int64_t  unbound,
+                         const int64_t  locked,
+                         const uint64_t checksum);
+   void     add_drops(const name     owner,
+                      const int64_t  bound,
+                      const int64_t  unbound,
+                      const int64_t  locked,
+                      const uint64_t checksum);
+   void     reduce_drops(const name owner, const int64_t bound, const int64_t unbound, const uint64_t checksum);
+   void     transfer_drops(const name from, const name to, const int64_t amount, const uint64_t checksum);
+   void     update_counters(const name owner, const int64_t bound, const int64_t unbound, const int64_t locked);
+   void     modify_drops(const name     owner,
+                         const int64_t  bound,
+                         const int64_t  unbound,
+                         const int64_t  locked,
+                         const uint64_t checksum);
+   uint64_t xor_seeds(const vector<uint64_t>& seeds);
+   uint64_t xor_seeds(const vector<drop_row>& drops);
 
    // modify RAM operations
    void check_drop_owner(const drop_row drop, const name owner);
@@ -355,25 +1468,60 @@ private:
    void modify_owner(const uint64_t drop_id, const name current_owner, const name new_owner);
    void modify_ram_payer(const uint64_t drop_id, const name owner, const bool bound);
    bool open_balance(const name owner, const name ram_payer);
+   bool close_balance(const name owner);
    name auth_ram_payer(const name owner);
 
+   // approvals
+   void use_approval(const name owner, const name approved, const int64_t amount);
+
    // sequence
    uint64_t get_sequence();
    uint64_t set_sequence(const int64_t amount);
+   uint64_t next_sequence(const name owner, const uint32_t amount);
+   uint64_t peek_sequence(const name owner, const uint32_t amount);
+
+   // sharding
+   uint64_t partition_seed(const uint64_t seed);
+   uint8_t  owner_shard(const name owner, const uint8_t shard_bits);
 
    // create and destroy
-   generate_return_value emplace_drops(const name             owner,
-                                       const bool             bound,
-                                       const uint32_t         amount,
-                                       const string           data,
-                                       const optional<name>   to_notify,
-                                       const optional<string> memo);
-   drop_row              destroy_drop(const uint64_t drop_id, const name owner);
+   generatesafe_return_value emplace_drops(const name             owner,
+                                           const name             to,
+                                           const bool             bound,
+                                           const bool             locked,
+                                           const uint32_t         amount,
+                                           const string           data,
+                                           const optional<name>   to_notify,
+                                           const optional<string> memo,
+                                           const int64_t          bytes_deposited,
+                                           const name             on_collision);
+   vector<drop_row>          generate_drops(const name     owner,
+                                            const bool     bound,
+                                            const uint32_t start,
+                                            const uint32_t amount,
+                                            const uint64_t sequence,
+                                            const string&  data,
+                                            const name     on_collision,
+                                            int64_t&       collisions);
+   drop_row                  emplace_drop(drop_table& _drops, const uint64_t seed, const name owner, const bool bound);
+   drop_row                  destroy_drop(const uint64_t drop_id, const name owner);
+   destroy_return_value      reclaim_destroyed(const name             owner,
+                                               const vector<drop_row> drops,
+                                               const int64_t          unbound_destroyed,
+                                               const optional<string> memo,
+                                               const optional<name>   to_notify,
+                                               const optional<name>   claim_to);
 
    // logging
    void log_drops(const name owner, const int64_t amount, const int64_t before_drops, const int64_t drops);
    void log_ram_bytes(const name owner, const int64_t bytes, const int64_t before_ram_bytes, const int64_t ram_bytes);
 
+   // balances reduced during the action, closed when empty once the action completes
+   std::set<name> emptied_balances;
+
+   // seed partition of the deployment (mask & prefix), loaded once per action
+   optional<pair<uint64_t, uint64_t>> seed_partition;
+
 // DEBUG (used to help testing)
 #ifdef DEBUG
    template <typename T>
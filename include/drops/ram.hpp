@@ -2,6 +2,32 @@
 
 namespace eosiosystem {
 
+// RAM market quote, the market is loaded once and every price is computed from it without further reads
+struct ram_quote
+{
+   int64_t ram_reserve;
+   int64_t eos_reserve;
+   symbol  core_symbol;
+
+   ram_quote(symbol core_symbol);
+
+   // EOS cost of buying bytes
+   asset cost(int64_t bytes) const;
+   asset cost_with_fee(int64_t bytes) const;
+
+   // EOS proceeds of selling bytes
+   asset proceeds(int64_t bytes) const;
+   asset proceeds_minus_fee(int64_t bytes) const;
+
+   // bytes bought with EOS
+   int64_t bytes(const asset quantity) const;
+   int64_t bytes_with_fee(const asset quantity) const;
+
+   // multi-amount quotes
+   std::vector<asset>   costs_with_fee(const std::vector<int64_t>& amounts) const;
+   std::vector<int64_t> bytes_with_fee(const std::vector<asset>& quantities) const;
+};
+
 int64_t get_bancor_input(int64_t out_reserve, int64_t inp_reserve, int64_t out);
 
 asset ram_cost(uint32_t bytes, symbol core_symbol);
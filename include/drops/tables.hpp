@@ -0,0 +1,156 @@
+#pragma once
+
+#include <eosio/binary_extension.hpp>
+#include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+
+// Table definitions of the drops contract, shared by the contract and the partner contracts reading its tables (see
+// `drops/client.hpp`). Kept free of the contract class and of namespace-wide `using` directives, the tables are bound
+// to the drops contract so they are only emitted in its ABI.
+namespace dropssystem {
+
+using eosio::binary_extension;
+using eosio::block_timestamp;
+using eosio::current_block_time;
+using eosio::name;
+
+inline uint128_t combine_ids(const uint64_t& v1, const uint64_t& v2) { return (uint128_t{v1} << 64) | v2; }
+
+/**
+ * ## TABLE `drops`
+ *
+ * ### params
+ *
+ * - `{uint64_t} seed` - (primary key) unique seed
+ * - `{name} owner` - owner of the drop
+ * - `{block_timestamp} created` - creation time
+ * - `{bool} bound` - whether the drop is bound to an account
+ *
+ * ### example
+ *
+ * ```json
+ * {
+ *   "seed": 16355392114041409,
+ *   "owner": "test.gm",
+ *   "created": "2024-01-29T00:00:00.000",
+ *   "bound": false
+ * }
+ * ```
+ */
+struct [[eosio::table("drop"), eosio::contract("drops")]] drop_row
+{
+   uint64_t        seed;
+   name            owner;
+   block_timestamp created;
+   bool            bound;
+   uint64_t        primary_key() const { return seed; }
+   uint128_t       by_owner() const { return ((uint128_t)owner.value << 64) | seed; }
+};
+
+/**
+ * ## TABLE `lock`
+ *
+ * ### params
+ *
+ * - `{uint64_t} seed` - (primary key) unique seed
+ *
+ * ### example
+ *
+ * ```json
+ * {
+ *   "seed": 16355392114041409,
+ * }
+ * ```
+ */
+struct [[eosio::table("lock"), eosio::contract("drops")]] lock_row
+{
+   uint64_t seed;
+   uint64_t primary_key() const { return seed; }
+};
+
+/**
+ * ## TABLE `state`
+ *
+ * ### params
+ *
+ * - `{block_timestamp} genesis` - genesis time when the contract was created
+ * - `{int64_t} bytes_per_drop` - amount of RAM bytes required per minting drop
+ * - `{uint64_t} sequence` - sequence is used as a salt to add an extra layer of complexity and randomness to the
+ * hashing process.
+ * - `{bool} enabled` - whether the contract is enabled
+ *
+ * ### example
+ *
+ * ```json
+ * {
+ *   "genesis": "2024-01-29T00:00:00",
+ *   "bytes_per_drop": 277,
+ *   "sequence": 0,
+ *   "enabled": true
+ * }
+ * ```
+ */
+struct [[eosio::table("state"), eosio::contract("drops")]] state_row
+{
+   block_timestamp genesis        = current_block_time();
+   int64_t         bytes_per_drop = 277; // 133 bytes primary row + 144 bytes secondary row
+   uint64_t        sequence       = 0;   // auto-incremented on each drop generation
+   bool            enabled        = true;
+};
+
+/**
+ * ## TABLE `balances`
+ *
+ * Balances opened before the counters and checksum were introduced are not `migrated` until they are recounted with
+ * `migrate`. Their counters are not maintained in the meantime (a legacy row written back reads them as 0).
+ *
+ * ### params
+ *
+ * - `{name} owner` - (primary key) owner account
+ * - `{int64_t} drops` - total amount of drops owned
+ * - `{int64_t} ram_bytes` - total amount of RAM bytes available by the owner
+ * - `{int64_t} [bound]` - amount of bound drops owned
+ * - `{int64_t} [unbound]` - amount of unbound drops owned
+ * - `{int64_t} [locked]` - amount of locked drops owned
+ * - `{uint64_t} [checksum]` - XOR of the seeds of all drops owned
+ * - `{bool} [migrated]` - whether the counters and checksum are maintained (opened or recounted by `migrate`)
+ *
+ * ### example
+ *
+ * ```json
+ * {
+ *   "owner": "test.gm",
+ *   "drops": 69,
+ *   "ram_bytes": 2048,
+ *   "bound": 9,
+ *   "unbound": 60,
+ *   "locked": 3,
+ *   "checksum": "7035598365496988505",
+ *   "migrated": true
+ * }
+ * ```
+ */
+struct [[eosio::table("balances"), eosio::contract("drops")]] balances_row
+{
+   name                       owner;
+   int64_t                    drops;
+   int64_t                    ram_bytes;
+   binary_extension<int64_t>  bound;
+   binary_extension<int64_t>  unbound;
+   binary_extension<int64_t>  locked;
+   binary_extension<uint64_t> checksum;
+   binary_extension<bool>     migrated;
+
+   uint64_t primary_key() const { return owner.value; }
+};
+
+typedef eosio::multi_index<
+   "drop"_n,
+   drop_row,
+   eosio::indexed_by<"owner"_n, eosio::const_mem_fun<drop_row, uint128_t, &drop_row::by_owner>>>
+                                                       drop_table;
+typedef eosio::multi_index<"lock"_n, lock_row>         lock_table;
+typedef eosio::singleton<"state"_n, state_row>         state_table;
+typedef eosio::multi_index<"balances"_n, balances_row> balances_table;
+
+} // namespace dropssystem
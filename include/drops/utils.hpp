@@ -11,6 +11,8 @@ static name parse_name(const string& str);
 
 static vector<string> split(const string& str, const char delim);
 
+static vector<string> split(const string& str, const char delim, const size_t limit);
+
 static int64_t to_number(const string& str);
 
 } // namespace utils
\ No newline at end of file
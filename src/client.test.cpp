@@ -0,0 +1,39 @@
+// Compile check of `drops/client.hpp` from a partner contract, which only includes the drops table definitions.
+//
+// $ make test/client
+
+#include <eosio/eosio.hpp>
+
+#include "drops/client.hpp"
+
+class [[eosio::contract("clienttest")]] clienttest : public eosio::contract
+{
+public:
+   using eosio::contract::contract;
+
+   [[eosio::action]] void verify(const eosio::name code, const eosio::name owner, const std::vector<uint64_t> seeds)
+   {
+      const dropssystem::client drops(code);
+      eosio::check(drops.is_enabled(), "Drops system is disabled.");
+      eosio::check(drops.owns_all(owner, seeds), "Drops must be owned by the owner.");
+      eosio::check(drops.all_transferable(owner, seeds), "Drops must be unbound and unlocked.");
+
+      for (const uint64_t seed : seeds) {
+         const auto drop = drops.get(seed);
+         eosio::check(drop.has_value() && drops.exists(seed), "Drop not found.");
+         eosio::check(!drops.is_bound(seed) && !drops.is_locked(seed), "Drop cannot be transferred.");
+      }
+
+      const auto balance = drops.balance(owner);
+      eosio::check(balance.has_value() && balance->drops == drops.count(owner), "Balance does not match the count.");
+      eosio::check(drops.bound(owner) + drops.unbound(owner) <= drops.count(owner), "Counters exceed the count.");
+      eosio::check(drops.locked(owner) <= drops.count(owner), "Locked drops exceed the count.");
+
+      uint32_t                      visited = 0;
+      const std::optional<uint64_t> next    = drops.for_each(owner, 100, {}, [&](const dropssystem::drop_row& row) {
+         visited++;
+         return row.owner == owner;
+      });
+      eosio::check(visited <= 100 && (!next || visited == 100), "Invalid walk of the owner drops.");
+   }
+};
@@ -12,6 +12,15 @@
 
 namespace dropssystem {
 
+drops::~drops()
+{
+   // balances are closed once the action has applied all of its balance updates,
+   // a balance emptied midway (ex: RAM bytes consumed before drops are credited) is not closed
+   for (const name owner : emptied_balances) {
+      close_balance(owner);
+   }
+}
+
 // @user
 [[eosio::on_notify("*::transfer")]] int64_t
 drops::on_transfer(const name from, const name to, const asset quantity, const string memo)
@@ -40,19 +49,14 @@ drops::on_transfer(const name from, const name to, const asset quantity, const s
    check(!memo.empty(), ERROR_INVALID_MEMO);
    check_is_enabled(get_self());
 
-   // validate memo
-   const name receiver = utils::parse_name(memo);
-   check(receiver.value, ERROR_INVALID_MEMO); // ensure receiver is not empty & valid Name type
-   check(is_account(receiver), ERROR_ACCOUNT_NOT_EXISTS);
-
-   if (FLAG_FORCE_RECEIVER_TO_BE_SENDER) {
-      check(receiver == from, "Receiver must be the same as the sender.");
-   }
-
    // contract purchase bytes and credit to receiver
-   const int64_t bytes = eosiosystem::bytes_cost_with_fee(quantity);
-   buy_ram(quantity);
-   add_ram_bytes(receiver, bytes);
+   // NOTE: in inventory mode, bytes are credited from the RAM float and purchased when the inventory is settled
+   const eosiosystem::ram_quote quote(EOS);
+   const int64_t                bytes = quote.bytes_with_fee(quantity);
+   if (!credit_inventory(quote, quantity, bytes)) {
+      buy_ram(quantity);
+   }
+   deposit_ram_bytes(from, memo, bytes);
    return bytes;
 }
 
@@ -70,8 +74,21 @@ drops::on_ramtransfer(const name from, const name to, const int64_t bytes, const
    check(!memo.empty(), ERROR_INVALID_MEMO);
    check_is_enabled(get_self());
 
+   // credit bytes to receiver
+   deposit_ram_bytes(from, memo, bytes);
+}
+
+// Deposit memo formats:
+// - "<receiver>" credits the bytes to the receiver
+// - "generate,<receiver>,<amount>,<data>" credits the bytes and generates unbound drops for the receiver
+//   (amount of 0 generates as many drops as the deposited bytes cover, data may contain commas)
+void drops::deposit_ram_bytes(const name from, const string memo, const int64_t bytes)
+{
+   const vector<string> params   = utils::split(memo, ',', 4);
+   const bool           generate = params.size() == 4 && params[0] == "generate";
+
    // validate memo
-   const name receiver = utils::parse_name(memo);
+   const name receiver = utils::parse_name(generate ? params[1] : memo);
    check(receiver.value, ERROR_INVALID_MEMO); // ensure receiver is not empty & valid Name type
    check(is_account(receiver), ERROR_ACCOUNT_NOT_EXISTS);
 
@@ -79,8 +96,19 @@ drops::on_ramtransfer(const name from, const name to, const int64_t bytes, const
       check(receiver == from, "Receiver must be the same as the sender.");
    }
 
-   // contract purchase bytes and credit to receiver
-   add_ram_bytes(receiver, bytes);
+   if (!generate) {
+      add_ram_bytes(receiver, bytes);
+      return;
+   }
+
+   // generate drops using the deposited bytes, credited within the same balance update
+   check(receiver != get_self(), "Cannot generate drops for contract.");
+   const int64_t requested = utils::to_number(params[2]);
+   const int64_t amount    = requested > 0 ? requested : bytes / get_bytes_per_drop();
+   check(amount > 0, "Deposit does not cover the RAM bytes of a single drop.");
+   check(amount <= std::numeric_limits<uint32_t>::max(), "The amount of drops to generate is too large.");
+   emplace_drops(receiver, receiver, false, false, amount, params[3], optional<name>(), optional<string>(), bytes,
+                 name());
 }
 
 // @user
@@ -95,18 +123,68 @@ drops::on_ramtransfer(const name from, const name to, const int64_t bytes, const
    check_is_enabled(get_self());
    check(owner != get_self(), "Cannot generate drops for contract.");
    open_balance(owner, owner);
-   return emplace_drops(owner, bound, amount, data, to_notify, memo);
+   const generatesafe_return_value result =
+      emplace_drops(owner, owner, bound, false, amount, data, to_notify, memo, 0, name());
+   return {result.bytes_used, result.bytes_balance};
 }
 
-drops::generate_return_value drops::emplace_drops(const name             owner,
-                                                  const bool             bound,
-                                                  const uint32_t         amount,
-                                                  const string           data,
-                                                  const optional<name>   to_notify,
-                                                  const optional<string> memo)
+// @user
+[[eosio::action]] drops::generatesafe_return_value drops::generatesafe(const name             owner,
+                                                                       const bool             bound,
+                                                                       const uint32_t         amount,
+                                                                       const string           data,
+                                                                       const name             on_collision,
+                                                                       const optional<name>   to_notify,
+                                                                       const optional<string> memo)
 {
-   drop_table _drops(get_self(), get_self().value);
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(owner != get_self(), "Cannot generate drops for contract.");
+   check(on_collision == "resalt"_n || on_collision == "skip"_n, "Collision mode must be \"resalt\" or \"skip\".");
+   open_balance(owner, owner);
+   return emplace_drops(owner, owner, bound, false, amount, data, to_notify, memo, 0, on_collision);
+}
 
+// @user
+[[eosio::action]] drops::generate_return_value drops::generateopts(const name             owner,
+                                                                   const bool             bound,
+                                                                   const uint32_t         amount,
+                                                                   const string           data,
+                                                                   const bool             locked,
+                                                                   const optional<name>   to,
+                                                                   const optional<name>   to_notify,
+                                                                   const optional<string> memo)
+{
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(owner != get_self(), "Cannot generate drops for contract.");
+   open_balance(owner, owner);
+
+   // drops generated for a recipient are unbound, their RAM bytes are paid by the owner
+   const name recipient = to ? *to : owner;
+   if (recipient != owner) {
+      check(!bound, "Bound drops cannot be generated for another account.");
+      check(is_account(recipient), ERROR_ACCOUNT_NOT_EXISTS);
+      check(recipient != get_self(), "Cannot generate drops for contract.");
+      open_balance(recipient, owner);
+      notify(recipient, NOTIFY_GENERATE);
+   }
+   const generatesafe_return_value result =
+      emplace_drops(owner, recipient, bound, locked, amount, data, to_notify, memo, 0, name());
+   return {result.bytes_used, result.bytes_balance};
+}
+
+drops::generatesafe_return_value drops::emplace_drops(const name             owner,
+                                                      const name             to,
+                                                      const bool             bound,
+                                                      const bool             locked,
+                                                      const uint32_t         amount,
+                                                      const string           data,
+                                                      const optional<name>   to_notify,
+                                                      const optional<string> memo,
+                                                      const int64_t          bytes_deposited,
+                                                      const name             on_collision)
+{
    // Ensure amount is a positive value
    check(amount > 0, "The amount of drops to generate must be a positive value.");
 
@@ -116,47 +194,239 @@ drops::generate_return_value drops::emplace_drops(const name             owner,
    // the sequence is used as a salt to add an extra layer of complexity and randomness to the hashing process.
    // the sequence is incremented each time a new Drop is generated to ensure that each hash is unique, even if the
    // input data is the same.
-   const uint64_t sequence = get_sequence();
+   const uint64_t sequence = next_sequence(owner, amount);
+
+   int64_t collisions = 0;
 
    // Iterate over all drops to be created and insert them into the drops table
+   const vector<drop_row> drops = generate_drops(to, bound, 0, amount, sequence, data, on_collision, collisions);
+
+   record_changes(CHANGE_MINT, drops);
+
+   // lock the generated drops without reading them back
+   if (locked) {
+      drops::lock_table _locks(get_self(), get_self().value);
+      for (const drop_row& drop : drops) {
+         _locks.emplace(owner, [&](auto& row) { row.seed = drop.seed; });
+      }
+      record_changes(CHANGE_LOCK, drops);
+   }
+
+   // colliding drops are not generated when skipped
+   const int64_t generated = drops.size();
+
+   // generating unbond drops consumes contract RAM bytes to owner
+   // else: bound drops do not consume contract RAM bytes
+   // NOTE: deposited RAM bytes are credited in the same balance update, skipped drops do not consume RAM bytes
+   const int64_t bytes_used    = generated * get_bytes_per_drop();
+   const int64_t bytes         = bytes_deposited - (bound ? 0 : bytes_used);
+   const int64_t bytes_balance = bytes != 0 ? update_ram_bytes(owner, bytes) : get_ram_bytes(owner);
+
+   // update recipient's drop balance
+   if (generated > 0) {
+      add_drops(to, bound ? generated : 0, bound ? 0 : generated, locked ? generated : 0, xor_seeds(drops));
+   }
+
+   // logging
+   drops::loggenerate_action loggenerate_act{get_self(), {get_self(), "active"_n}};
+   loggenerate_act.send(owner, to_notify ? drops : vector<drop_row>(), drops.size(), bytes_used, bytes_balance, data,
+                        to_notify, memo);
+
+   // action return value
+   return {bytes_used, bytes_balance, generated, collisions};
+}
+
+vector<drops::drop_row> drops::generate_drops(const name     owner,
+                                              const bool     bound,
+                                              const uint32_t start,
+                                              const uint32_t amount,
+                                              const uint64_t sequence,
+                                              const string&  data,
+                                              const name     on_collision,
+                                              int64_t&       collisions)
+{
+   drop_table _drops(get_self(), get_self().value);
+
    vector<drop_row> drops;
-   for (int i = 0; i < amount; i++) {
-      const uint64_t seed = hash_data(to_string(i) + to_string(sequence + i) + data);
+   for (uint32_t i = start; i < start + amount; i++) {
+      uint64_t seed = generate_seed(i, sequence, data);
 
       // Ensure first drop does not already exist
-      // NOTE: subsequent drops are not checked for performance reasons
-      if (i == 0) {
-         check(_drops.find(seed) == _drops.end(), "Drop " + to_string(seed) + " already exists.");
+      // NOTE: subsequent drops are not checked for performance reasons, unless collisions are handled
+      if (!on_collision.value) {
+         if (i == start) {
+            check(_drops.find(seed) == _drops.end(), "Drop " + to_string(seed) + " already exists.");
+         }
+      } else if (_drops.find(seed) != _drops.end()) {
+         collisions++;
+         if (on_collision == "skip"_n) {
+            continue;
+         }
+         seed = resalt_seed(_drops, seed);
       }
 
-      // Determine the payer with bound = owner, unbound = contract
-      const name ram_payer = bound ? owner : get_self();
-      _drops.emplace(ram_payer, [&](auto& row) {
-         row.seed    = seed;
-         row.owner   = owner;
-         row.bound   = bound;
-         row.created = current_block_time();
+      // Add the drop to the list of drops to be used in the logging action
+      drops.push_back(emplace_drop(_drops, seed, owner, bound));
+   }
+   return drops;
+}
 
-         // Add the drop to the list of drops to be used in the logging action
-         drops.push_back(row);
-      });
+// @user
+[[eosio::action]] uint64_t
+drops::jobcreate(const name owner, const bool bound, const uint32_t amount, const string data)
+{
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(owner != get_self(), "Cannot generate drops for contract.");
+   check(amount > 0, "The amount of drops to generate must be a positive value.");
+   check(data.length() >= 32, "Drop data must be at least 32 characters in length.");
+   open_balance(owner, owner);
+
+   // reserve the RAM bytes of unbound drops up front
+   if (bound == false) {
+      reduce_ram_bytes(owner, amount * get_bytes_per_drop());
    }
 
-   // Set the global sequence to the next value
-   set_sequence(amount);
+   // reserve the sequence range of the job
+   const uint64_t sequence = next_sequence(owner, amount);
+
+   drops::job_table _jobs(get_self(), get_self().value);
+   const uint64_t   job_id = _jobs.available_primary_key();
+   _jobs.emplace(owner, [&](auto& row) {
+      row.id        = job_id;
+      row.owner     = owner;
+      row.bound     = bound;
+      row.amount    = amount;
+      row.generated = 0;
+      row.sequence  = sequence;
+      row.data      = data;
+   });
+   return job_id;
+}
 
-   // Current RAM bytes balance
-   int64_t       bytes_balance = get_ram_bytes(owner);
-   const int64_t bytes_used    = amount * get_bytes_per_drop();
+// @user
+[[eosio::action]] drops::jobcontinue_return_value
+drops::jobcontinue(const name owner, const uint64_t job_id, const uint32_t max_amount)
+{
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(max_amount > 0, "The amount of drops to generate must be a positive value.");
 
-   // generating unbond drops consumes contract RAM bytes to owner
-   if (bound == false) {
-      bytes_balance = reduce_ram_bytes(owner, bytes_used);
+   drops::job_table _jobs(get_self(), get_self().value);
+   auto&            job = _jobs.get(job_id, "Job not found.");
+   check(job.owner == owner, "Job does not belong to account.");
+
+   // balance may have been closed once its RAM bytes were reserved by the job
+   open_balance(owner, owner);
+
+   // generate the next chunk using the reserved sequence range
+   const uint32_t amount     = std::min(max_amount, job.amount - job.generated);
+   int64_t        collisions = 0;
+
+   const vector<drop_row> drops =
+      generate_drops(owner, job.bound, job.generated, amount, job.sequence, job.data, name(), collisions);
+   add_drops(owner, job.bound ? amount : 0, job.bound ? 0 : amount, 0, xor_seeds(drops));
+   record_changes(CHANGE_MINT, drops);
+
+   // logging
+   // NOTE: RAM bytes of unbound drops were consumed when the job was created
+   const int64_t             bytes_used    = amount * get_bytes_per_drop();
+   const int64_t             bytes_balance = get_ram_bytes(owner);
+   drops::loggenerate_action loggenerate_act{get_self(), {get_self(), "active"_n}};
+   loggenerate_act.send(owner, vector<drop_row>(), drops.size(), bytes_used, bytes_balance, job.data,
+                        optional<name>(), optional<string>());
+
+   // remove the job once all drops have been generated
+   const int64_t remaining = job.amount - job.generated - amount;
+   if (remaining == 0) {
+      _jobs.erase(job);
+   } else {
+      _jobs.modify(job, same_payer, [&](auto& row) { row.generated += amount; });
    }
-   // else: bound drops do not consume contract RAM bytes
 
-   // update owner's drop balance
-   add_drops(owner, amount);
+   // action return value
+   return {amount, remaining};
+}
+
+// @user
+[[eosio::action]] int64_t drops::jobcancel(const name owner, const uint64_t job_id)
+{
+   require_auth(owner);
+
+   drops::job_table _jobs(get_self(), get_self().value);
+   auto&            job = _jobs.get(job_id, "Job not found.");
+   check(job.owner == owner, "Job does not belong to account.");
+
+   // return the reserved RAM bytes of drops that were not generated
+   int64_t bytes = 0;
+   if (job.bound == false) {
+      bytes = (job.amount - job.generated) * get_bytes_per_drop();
+      open_balance(owner, owner);
+      add_ram_bytes(owner, bytes);
+   }
+   _jobs.erase(job);
+   return bytes;
+}
+
+// @user
+[[eosio::action]] drops::generate_return_value drops::airdrop(const name                  owner,
+                                                              const vector<airdrop_entry> recipients,
+                                                              const string                data,
+                                                              const optional<name>        to_notify,
+                                                              const optional<string>      memo)
+{
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(owner != get_self(), "Cannot generate drops for contract.");
+   check(recipients.size() > 0, "No recipients were provided.");
+   check(data.length() >= 32, "Drop data must be at least 32 characters in length.");
+   open_balance(owner, owner);
+
+   // total amount of drops to generate
+   int64_t amount = 0;
+   for (const airdrop_entry& recipient : recipients) {
+      amount += recipient.amount;
+   }
+   check(amount <= std::numeric_limits<uint32_t>::max(), "The amount of drops to generate is too large.");
+
+   const uint64_t sequence = next_sequence(owner, amount);
+
+   // Generate each recipient's drops with their final owner, seeds follow the same sequence as `generate`
+   // amounts are aggregated per recipient
+   vector<drop_row>    drops;
+   uint32_t            index      = 0;
+   uint64_t            checksum   = 0;
+   int64_t             collisions = 0;
+   map<name, int64_t>  received;
+   map<name, uint64_t> received_checksum;
+   for (const airdrop_entry& recipient : recipients) {
+      check(recipient.amount > 0, "The amount of drops to generate must be a positive value.");
+      check(is_account(recipient.to), ERROR_ACCOUNT_NOT_EXISTS);
+      check(recipient.to != get_self(), "Cannot generate drops for contract.");
+
+      const vector<drop_row> generated =
+         generate_drops(recipient.to, false, index, recipient.amount, sequence, data, name(), collisions);
+      const uint64_t recipient_checksum = xor_seeds(generated);
+      received[recipient.to] += recipient.amount;
+      received_checksum[recipient.to] ^= recipient_checksum;
+      drops.insert(drops.end(), generated.begin(), generated.end());
+      checksum ^= recipient_checksum;
+      index += recipient.amount;
+   }
+
+   // each recipient balance is only modified once
+   for (const auto& [to, amount] : received) {
+      open_balance(to, owner);
+      modify_drops(to, 0, amount, 0, received_checksum[to]);
+   }
+
+   // airdropped drops are unbound, the owner pays for all of them
+   const int64_t bytes_used    = index * get_bytes_per_drop();
+   const int64_t bytes_balance = reduce_ram_bytes(owner, bytes_used);
+
+   // add drops to contract (used for global limits)
+   modify_drops(get_self(), 0, index, 0, checksum);
+   record_changes(CHANGE_MINT, drops);
 
    // logging
    drops::loggenerate_action loggenerate_act{get_self(), {get_self(), "active"_n}};
@@ -167,6 +437,60 @@ drops::generate_return_value drops::emplace_drops(const name             owner,
    return {bytes_used, bytes_balance};
 }
 
+drops::drop_row drops::emplace_drop(drop_table& _drops, const uint64_t seed, const name owner, const bool bound)
+{
+   drop_row drop;
+
+   // Determine the payer with bound = owner, unbound = contract
+   const name ram_payer = bound ? owner : get_self();
+   _drops.emplace(ram_payer, [&](auto& row) {
+      row.seed    = seed;
+      row.owner   = owner;
+      row.bound   = bound;
+      row.created = current_block_time();
+      drop        = row;
+   });
+   return drop;
+}
+
+uint64_t drops::resalt_seed(const drop_table& _drops, const uint64_t seed)
+{
+   for (uint32_t salt = 1; salt <= MAX_RESALT_ATTEMPTS; salt++) {
+      const uint64_t resalted = partition_seed(hash_data(to_string(seed) + ":" + to_string(salt)));
+      if (_drops.find(resalted) == _drops.end()) {
+         return resalted;
+      }
+   }
+   check(false, "Drop " + to_string(seed) + " could not be re-salted.");
+   return 0;
+}
+
+uint64_t drops::generate_seed(const uint32_t index, const uint64_t sequence, const string& data)
+{
+   return partition_seed(hash_data(to_string(index) + to_string(sequence + index) + data));
+}
+
+// seeds of a sharded deployment are generated within its partition, the prefix bits are replaced by the shard
+// NOTE: seeds of a deployment that is not sharded are left unchanged
+uint64_t drops::partition_seed(const uint64_t seed)
+{
+   if (!seed_partition) {
+      drops::shard_table _shard(get_self(), get_self().value);
+      const shard_row    shard  = _shard.get_or_default();
+      const int          shift  = 64 - shard.shard_bits;
+      const uint64_t     mask   = shard.shard_bits ? ~uint64_t(0) << shift : 0;
+      const uint64_t     prefix = shard.shard_bits ? uint64_t(shard.shard) << shift : 0;
+      seed_partition            = make_pair(mask, prefix);
+   }
+   return (seed & ~seed_partition->first) | seed_partition->second;
+}
+
+// owners are spread across shards by a multiplicative hash of their name
+uint8_t drops::owner_shard(const name owner, const uint8_t shard_bits)
+{
+   return shard_bits ? (owner.value * 0x9E3779B97F4A7C15) >> (64 - shard_bits) : 0;
+}
+
 uint64_t drops::hash_data(const string data)
 {
    auto     hash       = sha256(data.c_str(), data.length());
@@ -189,15 +513,178 @@ drops::transfer(const name from, const name to, const vector<uint64_t> droplet_i
    const int64_t amount = droplet_ids.size();
    check(amount > 0, ERROR_NO_DROPS);
    open_balance(to, from);
-   transfer_drops(from, to, amount);
+   transfer_drops(from, to, amount, xor_seeds(droplet_ids));
 
-   require_recipient(from);
-   require_recipient(to);
+   notify(from, NOTIFY_TRANSFER);
+   notify(to, NOTIFY_TRANSFER);
 
    // Iterate over all drops selected to be transferred
    for (const uint64_t drop_id : droplet_ids) {
       modify_owner(drop_id, from, to);
    }
+   record_changes(CHANGE_TRANSFER, droplet_ids, to);
+}
+
+// @user
+[[eosio::action]] void
+drops::transfermany(const name from, const vector<transfer_entry> transfers, const optional<string> memo)
+{
+   require_auth(from);
+   check_is_enabled(get_self());
+   check(transfers.size() > 0, ERROR_NO_DROPS);
+
+   // Iterate over all transfers, amounts are aggregated per recipient
+   int64_t             total    = 0;
+   uint64_t            checksum = 0;
+   map<name, int64_t>  received;
+   map<name, uint64_t> received_checksum;
+   for (const transfer_entry& transfer : transfers) {
+      const name to = transfer.to;
+      check(is_account(to), ERROR_ACCOUNT_NOT_EXISTS);
+      check(to != from, "Cannot transfer to self.");
+      check(to != get_self(), "Cannot transfer to contract.");
+      const int64_t amount = transfer.droplet_ids.size();
+      check(amount > 0, ERROR_NO_DROPS);
+
+      for (const uint64_t drop_id : transfer.droplet_ids) {
+         modify_owner(drop_id, from, to);
+      }
+      record_changes(CHANGE_TRANSFER, transfer.droplet_ids, to);
+
+      const uint64_t transfer_checksum = xor_seeds(transfer.droplet_ids);
+      received[to] += amount;
+      received_checksum[to] ^= transfer_checksum;
+      total += amount;
+      checksum ^= transfer_checksum;
+   }
+
+   // each recipient balance is only modified once
+   for (const auto& [to, amount] : received) {
+      open_balance(to, from);
+      modify_drops(to, 0, amount, 0, received_checksum[to]);
+      notify(to, NOTIFY_TRANSFER);
+   }
+
+   // sender balance is reduced once for all recipients
+   modify_drops(from, 0, -total, 0, checksum);
+   notify(from, NOTIFY_TRANSFER);
+}
+
+// @user
+[[eosio::action]] void drops::approve(const name owner, const name approved, const optional<uint64_t> limit)
+{
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(is_account(approved), ERROR_ACCOUNT_NOT_EXISTS);
+   check(approved != owner, "Cannot approve self.");
+   check(!limit || *limit > 0, "Approval limit must be a positive value.");
+
+   // unlimited approvals are stored with a remaining amount of 0
+   const uint64_t remaining = limit ? *limit : 0;
+
+   drops::approval_table _approvals(get_self(), get_self().value);
+   auto                  _approvals_by_owner = _approvals.get_index<"owner"_n>();
+   auto                  approval = _approvals_by_owner.find(combine_ids(owner.value, approved.value));
+   if (approval == _approvals_by_owner.end()) {
+      _approvals.emplace(owner, [&](auto& row) {
+         row.id        = _approvals.available_primary_key();
+         row.owner     = owner;
+         row.approved  = approved;
+         row.remaining = remaining;
+      });
+   } else {
+      _approvals_by_owner.modify(approval, owner, [&](auto& row) { row.remaining = remaining; });
+   }
+}
+
+// @user
+[[eosio::action]] void drops::unapprove(const name owner, const name approved)
+{
+   require_auth(owner);
+
+   drops::approval_table _approvals(get_self(), get_self().value);
+   auto                  _approvals_by_owner = _approvals.get_index<"owner"_n>();
+   auto                  approval = _approvals_by_owner.find(combine_ids(owner.value, approved.value));
+   check(approval != _approvals_by_owner.end(), "Approval not found.");
+   _approvals_by_owner.erase(approval);
+}
+
+// @user
+[[eosio::action]] void
+drops::transferfrom(const name approved, const vector<transfer_from_entry> transfers, const optional<string> memo)
+{
+   require_auth(approved);
+   check_is_enabled(get_self());
+   check(transfers.size() > 0, ERROR_NO_DROPS);
+
+   // each owner's approval is checked and consumed once for all of its transferred drops
+   map<name, int64_t> sent;
+   for (const transfer_from_entry& transfer : transfers) {
+      sent[transfer.from] += transfer.droplet_ids.size();
+   }
+   for (const auto& [from, amount] : sent) {
+      use_approval(from, approved, amount);
+   }
+
+   // Iterate over all transfers, balances are netted per account and each is only modified once
+   // NOTE: the checksum of a transferred drop is toggled for both the sender and the recipient
+   map<name, int64_t>  balances;
+   map<name, uint64_t> checksums;
+   for (const transfer_from_entry& transfer : transfers) {
+      const name from = transfer.from;
+      const name to   = transfer.to;
+      check(is_account(to), ERROR_ACCOUNT_NOT_EXISTS);
+      check(to != from, "Cannot transfer to self.");
+      check(to != get_self(), "Cannot transfer to contract.");
+      const int64_t amount = transfer.droplet_ids.size();
+      check(amount > 0, ERROR_NO_DROPS);
+      open_balance(to, approved);
+
+      for (const uint64_t drop_id : transfer.droplet_ids) {
+         modify_owner(drop_id, from, to);
+      }
+      record_changes(CHANGE_TRANSFER, transfer.droplet_ids, to);
+
+      const uint64_t transfer_checksum = xor_seeds(transfer.droplet_ids);
+      balances[from] -= amount;
+      balances[to] += amount;
+      checksums[from] ^= transfer_checksum;
+      checksums[to] ^= transfer_checksum;
+   }
+
+   // senders and recipients
+   for (const auto& [account, amount] : balances) {
+      modify_drops(account, 0, amount, 0, checksums[account]);
+      notify(account, NOTIFY_TRANSFER);
+   }
+}
+
+void drops::use_approval(const name owner, const name approved, const int64_t amount)
+{
+   // owners transferring their own drops do not require an approval
+   if (owner == approved) {
+      return;
+   }
+
+   drops::approval_table _approvals(get_self(), get_self().value);
+   auto                  _approvals_by_owner = _approvals.get_index<"owner"_n>();
+   auto                  approval = _approvals_by_owner.find(combine_ids(owner.value, approved.value));
+   check(approval != _approvals_by_owner.end(),
+         approved.to_string() + " is not approved to transfer drops of " + owner.to_string() + ".");
+
+   // unlimited approval
+   if (approval->remaining == 0) {
+      return;
+   }
+   check(approval->remaining >= static_cast<uint64_t>(amount),
+         "Transfer exceeds the approved amount of " + owner.to_string() + ".");
+
+   // exhausted approvals are removed, a remaining amount of 0 would otherwise be unlimited
+   if (approval->remaining == static_cast<uint64_t>(amount)) {
+      _approvals_by_owner.erase(approval);
+   } else {
+      _approvals_by_owner.modify(approval, same_payer, [&](auto& row) { row.remaining -= amount; });
+   }
 }
 
 void drops::modify_owner(const uint64_t drop_id, const name current_owner, const name new_owner)
@@ -257,6 +744,9 @@ void drops::modify_ram_payer(const uint64_t drop_id, const name owner, const boo
    for (const uint64_t drop_id : droplet_ids) {
       modify_ram_payer(drop_id, owner, true);
    }
+   const int64_t amount = droplet_ids.size();
+   update_counters(owner, amount, -amount, 0);
+   record_changes(CHANGE_BIND, droplet_ids, owner);
    return bytes;
 }
 
@@ -275,6 +765,9 @@ void drops::modify_ram_payer(const uint64_t drop_id, const name owner, const boo
    for (const uint64_t drop_id : droplet_ids) {
       modify_ram_payer(drop_id, owner, false);
    }
+   const int64_t amount = droplet_ids.size();
+   update_counters(owner, -amount, amount, 0);
+   record_changes(CHANGE_UNBIND, droplet_ids, owner);
    return bytes;
 }
 
@@ -288,6 +781,9 @@ void drops::modify_ram_payer(const uint64_t drop_id, const name owner, const boo
    for (const uint64_t drop_id : droplet_ids) {
       modify_locked(drop_id, owner, true);
    }
+   const int64_t amount = droplet_ids.size();
+   update_counters(owner, 0, 0, amount);
+   record_changes(CHANGE_LOCK, droplet_ids, owner);
 }
 
 // @user
@@ -300,6 +796,9 @@ void drops::modify_ram_payer(const uint64_t drop_id, const name owner, const boo
    for (const uint64_t drop_id : droplet_ids) {
       modify_locked(drop_id, owner, false);
    }
+   const int64_t amount = droplet_ids.size();
+   update_counters(owner, 0, 0, -amount);
+   record_changes(CHANGE_UNLOCK, droplet_ids, owner);
 }
 
 void drops::modify_locked(const uint64_t drop_id, const name owner, const bool locked)
@@ -346,6 +845,17 @@ void drops::notify(const optional<name> to_notify)
    }
 }
 
+void drops::notify(const name account, const uint8_t event)
+{
+   // accounts without subscription are notified of all events
+   drops::subscription_table _subscriptions(get_self(), get_self().value);
+   auto                      subscription = _subscriptions.find(account.value);
+   if (subscription != _subscriptions.end() && (subscription->events & event) == 0) {
+      return;
+   }
+   notify(optional<name>(account));
+}
+
 // @user
 [[eosio::action]] drops::destroy_return_value drops::destroy(const name             owner,
                                                              const vector<uint64_t> droplet_ids,
@@ -357,7 +867,6 @@ void drops::notify(const optional<name> to_notify)
    check_is_enabled(get_self());
    const int64_t amount = droplet_ids.size();
    check(amount > 0, ERROR_NO_DROPS);
-   reduce_drops(owner, amount);
 
    // The number of bound drops that were destroyed
    int64_t          unbound_destroyed = 0;
@@ -370,11 +879,108 @@ void drops::notify(const optional<name> to_notify)
       }
       drops.push_back(drop);
    }
+   return reclaim_destroyed(owner, drops, unbound_destroyed, memo, to_notify, optional<name>());
+}
+
+// @user
+[[eosio::action]] drops::destroy_return_value drops::destroyclaim(const name             owner,
+                                                                  const vector<uint64_t> droplet_ids,
+                                                                  const optional<name>   receiver,
+                                                                  const optional<string> memo,
+                                                                  const optional<name>   to_notify)
+{
+   require_auth(owner);
+
+   check_is_enabled(get_self());
+   const int64_t amount = droplet_ids.size();
+   check(amount > 0, ERROR_NO_DROPS);
+   const name claim_to = receiver ? *receiver : owner;
+   check(is_account(claim_to), ERROR_ACCOUNT_NOT_EXISTS);
+   check(claim_to != get_self(), "Cannot claim RAM bytes to contract.");
+
+   // The number of bound drops that were destroyed
+   int64_t          unbound_destroyed = 0;
+   vector<drop_row> drops;
+   for (const uint64_t drop_id : droplet_ids) {
+      // Count the number of "bound=false" drops destroyed
+      const drop_row drop = destroy_drop(drop_id, owner);
+      if (drop.bound == false) {
+         unbound_destroyed++;
+      }
+      drops.push_back(drop);
+   }
+   return reclaim_destroyed(owner, drops, unbound_destroyed, memo, to_notify, claim_to);
+}
+
+// @user
+[[eosio::action]] drops::destroyall_return_value drops::destroyall(const name               owner,
+                                                                   const uint32_t           limit,
+                                                                   const optional<uint64_t> cursor,
+                                                                   const optional<string>   memo,
+                                                                   const optional<name>     to_notify)
+{
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(limit > 0, "The limit must be a positive value.");
+
+   drops::drop_table _drops(get_self(), get_self().value);
+   drops::lock_table _locks(get_self(), get_self().value);
+   auto              _drops_by_owner = _drops.get_index<"owner"_n>();
+
+   // Walk the owner's drops starting from the cursor, visiting at most `limit` drops
+   auto             itr               = _drops_by_owner.lower_bound(combine_ids(owner.value, cursor ? *cursor : 0));
+   uint32_t         visited           = 0;
+   int64_t          unbound_destroyed = 0;
+   vector<drop_row> drops;
+   while (itr != _drops_by_owner.end() && itr->owner == owner && visited < limit) {
+      visited++;
+
+      // locked drops remain with the owner
+      if (_locks.find(itr->seed) != _locks.end()) {
+         itr++;
+         continue;
+      }
+      if (itr->bound == false) {
+         unbound_destroyed++;
+      }
+      drops.push_back(*itr);
+      itr = _drops_by_owner.erase(itr);
+   }
+
+   // Resume from the next drop of the owner (if any)
+   optional<uint64_t> next_cursor;
+   if (itr != _drops_by_owner.end() && itr->owner == owner) {
+      next_cursor = itr->seed;
+   }
+
+   // only locked drops were visited
+   if (drops.empty()) {
+      return {0, 0, 0, next_cursor};
+   }
+   const destroy_return_value result =
+      reclaim_destroyed(owner, drops, unbound_destroyed, memo, to_notify, optional<name>());
+   return {static_cast<int64_t>(drops.size()), result.unbound_destroyed, result.bytes_reclaimed, next_cursor};
+}
+
+drops::destroy_return_value drops::reclaim_destroyed(const name             owner,
+                                                     const vector<drop_row> drops,
+                                                     const int64_t          unbound_destroyed,
+                                                     const optional<string> memo,
+                                                     const optional<name>   to_notify,
+                                                     const optional<name>   claim_to)
+{
+   reduce_drops(owner, drops.size() - unbound_destroyed, unbound_destroyed, xor_seeds(drops));
+   record_changes(CHANGE_BURN, drops);
 
    // Calculate how much of their own RAM the account reclaimed
    const int64_t bytes_reclaimed = unbound_destroyed * get_bytes_per_drop();
    if (bytes_reclaimed > 0) {
-      add_ram_bytes(owner, bytes_reclaimed);
+      // claimed bytes are sent directly to the receiver, RAM bytes balances remain unchanged
+      if (claim_to) {
+         withdraw_ram_bytes(*claim_to, bytes_reclaimed);
+      } else {
+         add_ram_bytes(owner, bytes_reclaimed);
+      }
    }
 
    // logging
@@ -402,6 +1008,122 @@ drops::drop_row drops::destroy_drop(const uint64_t drop_id, const name owner)
    return drop;
 }
 
+// @user
+[[eosio::action]] int64_t
+drops::batch(const name owner, const vector<batch_operation> operations, const optional<string> memo)
+{
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(operations.size() > 0, "No operations were provided.");
+
+   // balance changes are accumulated and applied once at the end of the batch
+   const int64_t       bytes_per_drop    = get_bytes_per_drop();
+   int64_t             bytes             = 0;
+   int64_t             unbound_destroyed = 0;
+   int64_t             transferred       = 0;
+   int64_t             burned            = 0;
+   int64_t             bound_delta       = 0;
+   int64_t             unbound_delta     = 0;
+   int64_t             locked_delta      = 0;
+   uint64_t            checksum          = 0;
+   uint64_t            burned_checksum   = 0;
+   map<name, int64_t>  received;
+   map<name, uint64_t> received_checksum;
+
+   for (const batch_operation& operation : operations) {
+      const int64_t amount = operation.droplet_ids.size();
+      check(amount > 0, ERROR_NO_DROPS);
+
+      if (operation.action == "transfer"_n) {
+         check(operation.to.has_value(), "Transfer operation requires a recipient.");
+         const name to = *operation.to;
+         check(is_account(to), ERROR_ACCOUNT_NOT_EXISTS);
+         check(to != owner, "Cannot transfer to self.");
+         check(to != get_self(), "Cannot transfer to contract.");
+         open_balance(to, owner);
+         for (const uint64_t drop_id : operation.droplet_ids) {
+            modify_owner(drop_id, owner, to);
+         }
+         record_changes(CHANGE_TRANSFER, operation.droplet_ids, to);
+         const uint64_t transfer_checksum = xor_seeds(operation.droplet_ids);
+         received[to] += amount;
+         received_checksum[to] ^= transfer_checksum;
+         checksum ^= transfer_checksum;
+         transferred += amount;
+         unbound_delta -= amount;
+
+      } else if (operation.action == "destroy"_n) {
+         for (const uint64_t drop_id : operation.droplet_ids) {
+            const drop_row drop = destroy_drop(drop_id, owner);
+            if (drop.bound == false) {
+               unbound_destroyed++;
+               unbound_delta--;
+            } else {
+               bound_delta--;
+            }
+            burned++;
+         }
+         record_changes(CHANGE_BURN, operation.droplet_ids, owner);
+         const uint64_t destroy_checksum = xor_seeds(operation.droplet_ids);
+         checksum ^= destroy_checksum;
+         burned_checksum ^= destroy_checksum;
+
+      } else if (operation.action == "bind"_n || operation.action == "unbind"_n) {
+         // binding drops releases RAM to the owner, unbinding requires the owner to pay for the RAM
+         const bool bound = operation.action == "bind"_n;
+         bytes += (bound ? amount : -amount) * bytes_per_drop;
+         bound_delta += bound ? amount : -amount;
+         unbound_delta -= bound ? amount : -amount;
+         for (const uint64_t drop_id : operation.droplet_ids) {
+            modify_ram_payer(drop_id, owner, bound);
+         }
+         record_changes(bound ? CHANGE_BIND : CHANGE_UNBIND, operation.droplet_ids, owner);
+
+      } else if (operation.action == "lock"_n || operation.action == "unlock"_n) {
+         const bool locked = operation.action == "lock"_n;
+         locked_delta += locked ? amount : -amount;
+         for (const uint64_t drop_id : operation.droplet_ids) {
+            modify_locked(drop_id, owner, locked);
+         }
+         record_changes(locked ? CHANGE_LOCK : CHANGE_UNLOCK, operation.droplet_ids, owner);
+
+      } else {
+         check(false, "Unknown batch operation.");
+      }
+   }
+
+   // recipients
+   for (const auto& [to, amount] : received) {
+      modify_drops(to, 0, amount, 0, received_checksum[to]);
+      notify(to, NOTIFY_TRANSFER);
+   }
+
+   // owner
+   if (bound_delta != 0 || unbound_delta != 0 || locked_delta != 0) {
+      modify_drops(owner, bound_delta, unbound_delta, locked_delta, checksum);
+   }
+   if (transferred > 0) {
+      notify(owner, NOTIFY_TRANSFER);
+   }
+   bytes += unbound_destroyed * bytes_per_drop;
+   if (bytes != 0) {
+      update_ram_bytes(owner, bytes);
+   }
+
+   // global totals (transferred drops remain in the system)
+   if (bound_delta != 0 || unbound_delta + transferred != 0 || locked_delta != 0) {
+      modify_drops(get_self(), bound_delta, unbound_delta + transferred, locked_delta, burned_checksum);
+   }
+
+   // burn
+   if (burned > 0) {
+      drops::logdestroy_action logdestroy_act{get_self(), {get_self(), "active"_n}};
+      logdestroy_act.send(owner, vector<drop_row>(), burned, unbound_destroyed, unbound_destroyed * bytes_per_drop,
+                          memo, optional<name>());
+   }
+   return bytes;
+}
+
 // @user
 [[eosio::action]] bool drops::open(const name owner)
 {
@@ -423,6 +1145,11 @@ bool drops::open_balance(const name owner, const name ram_payer)
          row.owner     = owner;
          row.drops     = 0;
          row.ram_bytes = 0;
+         row.bound.emplace(0);
+         row.unbound.emplace(0);
+         row.locked.emplace(0);
+         row.checksum.emplace(0);
+         row.migrated.emplace(true);
       });
       return true;
    }
@@ -431,6 +1158,63 @@ bool drops::open_balance(const name owner, const name ram_payer)
    return false;
 }
 
+// @user
+[[eosio::action]] void drops::close(const name owner)
+{
+   require_auth(owner);
+   check(owner != get_self(), "Cannot close contract balance.");
+
+   drops::balances_table _balances(get_self(), get_self().value);
+   _balances.get(owner.value, ERROR_OPEN_BALANCE.c_str());
+   check(close_balance(owner), "Balance must not have any drops or RAM bytes to be closed.");
+}
+
+// @admin
+[[eosio::action]] drops::sweep_return_value drops::sweep(const uint32_t limit, const optional<name> cursor)
+{
+   require_auth(get_self());
+   check_is_enabled(get_self());
+   check(limit > 0, "The limit must be a positive value.");
+
+   drops::balances_table _balances(get_self(), get_self().value);
+
+   // Walk the balances starting from the cursor, visiting at most `limit` rows
+   auto     itr     = _balances.lower_bound(cursor ? cursor->value : 0);
+   uint32_t visited = 0;
+   int64_t  closed  = 0;
+   while (itr != _balances.end() && visited < limit) {
+      visited++;
+
+      // contract balance holds the global totals and is never closed
+      if (itr->owner == get_self() || itr->drops != 0 || itr->ram_bytes != 0) {
+         itr++;
+         continue;
+      }
+      itr = _balances.erase(itr);
+      closed++;
+   }
+
+   // Resume from the next balance (if any)
+   optional<name> next_cursor;
+   if (itr != _balances.end()) {
+      next_cursor = itr->owner;
+   }
+   return {closed, next_cursor};
+}
+
+bool drops::close_balance(const name owner)
+{
+   drops::balances_table _balances(get_self(), get_self().value);
+
+   auto balance = _balances.find(owner.value);
+   if (balance == _balances.end() || owner == get_self() || balance->drops != 0 || balance->ram_bytes != 0) {
+      return false;
+   }
+   // RAM is released to the payer of the row (owner or the sender that opened it)
+   _balances.erase(balance);
+   return true;
+}
+
 // @user
 [[eosio::action]] int64_t drops::claim(const name owner)
 {
@@ -441,17 +1225,7 @@ bool drops::open_balance(const name owner, const name ram_payer)
    const int64_t ram_bytes = _balances.get(owner.value, ERROR_OPEN_BALANCE.c_str()).ram_bytes;
    if (ram_bytes > 0) {
       reduce_ram_bytes(owner, ram_bytes);
-
-      // if enabled, transfer RAM bytes to owner
-      if (FLAG_ENABLE_RAM_TRANSFER_ON_CLAIM) {
-         transfer_ram(owner, ram_bytes, MEMO_RAM_TRANSFER);
-
-         // else, sell RAM bytes and transfer EOS to owner (0.5% fee to system contract)
-      } else {
-         sell_ram_bytes(ram_bytes);
-         const asset quantity = eosiosystem::ram_proceeds_minus_fee(ram_bytes, EOS);
-         transfer_tokens(owner, quantity, MEMO_RAM_SOLD_TRANSFER);
-      }
+      withdraw_ram_bytes(owner, ram_bytes);
       return ram_bytes;
    }
    // else: account does not have any RAM bytes to claim
@@ -482,6 +1256,9 @@ int64_t drops::modify_ram_bytes(const name owner, const int64_t bytes, const nam
       check(row.ram_bytes >= 0, owner.to_string() + " does not have enough RAM bytes.");
       log_ram_bytes(row.owner, bytes, before_ram_bytes, row.ram_bytes);
    });
+   if (FLAG_AUTO_CLOSE_BALANCES && bytes < 0) {
+      emptied_balances.insert(owner);
+   }
    return newBytesBalance;
 }
 
@@ -492,61 +1269,399 @@ int64_t drops::get_ram_bytes(const name owner)
    return balance.ram_bytes;
 }
 
-void drops::add_drops(const name owner, const int64_t amount) { return update_drops(name(), owner, amount); }
+void drops::add_drops(
+   const name owner, const int64_t bound, const int64_t unbound, const int64_t locked, const uint64_t checksum)
+{
+   return update_drops(name(), owner, bound, unbound, locked, checksum);
+}
+
+void drops::reduce_drops(const name owner, const int64_t bound, const int64_t unbound, const uint64_t checksum)
+{
+   return update_drops(owner, name(), bound, unbound, 0, checksum);
+}
 
-void drops::reduce_drops(const name owner, const int64_t amount) { return update_drops(owner, name(), amount); }
+void drops::transfer_drops(const name from, const name to, const int64_t amount, const uint64_t checksum)
+{
+   // only unbound & unlocked drops can be transferred
+   return update_drops(from, to, 0, amount, 0, checksum);
+}
 
-void drops::transfer_drops(const name from, const name to, const int64_t amount)
+uint64_t drops::xor_seeds(const vector<uint64_t>& seeds)
 {
-   return update_drops(from, to, amount);
+   uint64_t checksum = 0;
+   for (const uint64_t seed : seeds) {
+      checksum ^= seed;
+   }
+   return checksum;
+}
+
+uint64_t drops::xor_seeds(const vector<drop_row>& drops)
+{
+   uint64_t checksum = 0;
+   for (const drop_row& drop : drops) {
+      checksum ^= drop.seed;
+   }
+   return checksum;
 }
 
 // if authorized, owner shall always be the RAM payer of operations
 name drops::auth_ram_payer(const name owner) { return has_auth(owner) ? owner : same_payer; }
 
-void drops::update_drops(const name from, const name to, const int64_t amount)
+void drops::update_drops(const name     from,
+                         const name     to,
+                         const int64_t  bound,
+                         const int64_t  unbound,
+                         const int64_t  locked,
+                         const uint64_t checksum)
 {
-   drops::balances_table _balances(get_self(), get_self().value);
-
    // sender (if empty, minting new drops)
    if (from.value) {
-      auto& balance_from = _balances.get(from.value, ERROR_OPEN_BALANCE.c_str());
-      _balances.modify(balance_from, auth_ram_payer(from), [&](auto& row) {
-         const int64_t before_drops = row.drops;
-         row.drops -= amount;
-         log_drops(row.owner, amount, before_drops, row.drops);
-         check(row.drops >= 0, "Account does not have enough drops."); // should never happen
-      });
+      modify_drops(from, -bound, -unbound, -locked, checksum);
    }
 
    // receiver (if empty, burning drops)
    if (to.value) {
-      auto& balance_to = _balances.get(to.value, ERROR_OPEN_BALANCE.c_str());
-      _balances.modify(balance_to, same_payer, [&](auto& row) {
-         const int64_t before_drops = row.drops;
-         row.drops += amount;
-         log_drops(row.owner, amount, before_drops, row.drops);
-      });
+      modify_drops(to, bound, unbound, locked, checksum);
    }
 
    // add drops to contract (used for global limits)
    // NOTE: a way to keep track of the total amount of drops in the system
-   if (from.value == 0 || to.value == 0) {
-      auto& balance_self = _balances.get(get_self().value, ERROR_OPEN_BALANCE.c_str());
-
-      _balances.modify(balance_self, same_payer, [&](auto& row) {
-         const int64_t before_drops = row.drops;
-         // mint
-         if (from.value == 0) {
-            row.drops += amount;
-            // burn
-         } else if (to.value == 0) {
-            row.drops -= amount;
-         }
-         check(row.drops >= 0, "Contract does not have enough drops."); // should never happen
-         log_drops(row.owner, amount, before_drops, row.drops);
+   if (from.value == 0) {
+      modify_drops(get_self(), bound, unbound, locked, checksum); // mint
+   } else if (to.value == 0) {
+      modify_drops(get_self(), -bound, -unbound, -locked, checksum); // burn
+   }
+}
+
+void drops::update_counters(const name owner, const int64_t bound, const int64_t unbound, const int64_t locked)
+{
+   // drops changing state remain with the owner, only the counters are modified
+   modify_drops(owner, bound, unbound, locked, 0);
+   modify_drops(get_self(), bound, unbound, locked, 0);
+}
+
+void drops::modify_drops(
+   const name owner, const int64_t bound, const int64_t unbound, const int64_t locked, const uint64_t checksum)
+{
+   drops::balances_table _balances(get_self(), get_self().value);
+
+   const int64_t amount  = bound + unbound;
+   auto&         balance = _balances.get(owner.value, ERROR_OPEN_BALANCE.c_str());
+   _balances.modify(balance, auth_ram_payer(owner), [&](auto& row) {
+      const int64_t before_drops = row.drops;
+      row.drops += amount;
+      check(row.drops >= 0, owner == get_self() ? "Contract does not have enough drops."
+                                                : "Account does not have enough drops."); // should never happen
+
+      // counters are only maintained once the balance is migrated (see `migrate`), the extensions of a legacy row are
+      // written back as 0 and cannot tell whether the balance was migrated
+      const bool migrated = row.migrated.value_or(false);
+      if (migrated) {
+         row.bound.value() += bound;
+         row.unbound.value() += unbound;
+         row.locked.value() += locked;
+         row.checksum.value() ^= checksum;
+         check(*row.bound >= 0 && *row.unbound >= 0 && *row.locked >= 0,
+               "Drop counters cannot be negative."); // should never happen
+      }
+      if (amount != 0) {
+         log_drops(row.owner, std::abs(amount), before_drops, row.drops);
+      }
+   });
+   if (FLAG_AUTO_CLOSE_BALANCES && amount < 0) {
+      emptied_balances.insert(owner);
+   }
+}
+
+// @user
+[[eosio::action]] int64_t drops::settle()
+{
+   drops::inventory_table _inventory(get_self(), get_self().value);
+   auto                   inventory = _inventory.get_or_default();
+   const int64_t          bytes     = settle_inventory(eosiosystem::ram_quote(EOS), inventory);
+   if (bytes > 0) {
+      _inventory.set(inventory, get_self());
+   }
+   return bytes;
+}
+
+// @admin
+[[eosio::action]] void drops::setinventory(const bool enabled, const int64_t min_bytes, const asset max_pending)
+{
+   require_auth(get_self());
+   check(min_bytes >= 0, "Minimum bytes must be a non-negative value.");
+   check(max_pending.symbol == EOS && max_pending.amount >= 0, "Maximum pending must be a non-negative EOS quantity.");
+
+   drops::inventory_table _inventory(get_self(), get_self().value);
+   auto                   inventory = _inventory.get_or_default();
+
+   // settle any pending EOS before disabling the inventory mode
+   if (!enabled) {
+      settle_inventory(eosiosystem::ram_quote(EOS), inventory);
+   }
+   inventory.enabled     = enabled;
+   inventory.min_bytes   = min_bytes;
+   inventory.max_pending = max_pending;
+   _inventory.set(inventory, get_self());
+}
+
+// @admin
+[[eosio::action]] void drops::addinventory(const int64_t bytes)
+{
+   require_auth(get_self());
+
+   drops::inventory_table _inventory(get_self(), get_self().value);
+   auto                   inventory = _inventory.get_or_default();
+   inventory.bytes += bytes;
+   check(inventory.bytes >= 0, "Inventory bytes cannot be negative.");
+   _inventory.set(inventory, get_self());
+}
+
+// @admin
+[[eosio::action]] void drops::setjournal(const uint64_t capacity)
+{
+   require_auth(get_self());
+
+   drops::journal_state_table _state(get_self(), get_self().value);
+   drops::journal_table       _journal(get_self(), get_self().value);
+   auto                       state = _state.get_or_default();
+
+   // slots depend on the capacity, changes recorded before are no longer returned
+   if (state.capacity != capacity) {
+      state.capacity = capacity;
+      state.first    = state.next;
+      _state.set(state, get_self());
+   }
+
+   // release slots beyond the new capacity, the remaining slots are released by the following changes
+   trim_journal(state, _journal);
+}
+
+// @admin
+[[eosio::action]] void drops::setshard(const uint8_t shard_bits, const uint8_t shard)
+{
+   require_auth(get_self());
+   check(shard_bits <= 8, "Shard bits must be at most 8.");
+   check(shard < (1 << shard_bits), "Shard must be within the shard bits.");
+
+   // existing seeds would fall outside of the partition
+   drops::balances_table _balances(get_self(), get_self().value);
+   const auto            totals = _balances.find(get_self().value);
+   check(totals == _balances.end() || totals->drops == 0, "Shard can only be set before drops are generated.");
+
+   drops::shard_table _shard(get_self(), get_self().value);
+   _shard.set(shard_row{shard_bits, shard}, get_self());
+}
+
+// @admin
+[[eosio::action]] void drops::setroute(const uint8_t shard, const optional<name> account)
+{
+   require_auth(get_self());
+
+   drops::route_table _routes(get_self(), get_self().value);
+   auto               route = _routes.find(shard);
+
+   // remove route
+   if (!account) {
+      check(route != _routes.end(), "Route not found.");
+      _routes.erase(route);
+      return;
+   }
+   check(is_account(*account), ERROR_ACCOUNT_NOT_EXISTS);
+   if (route == _routes.end()) {
+      _routes.emplace(get_self(), [&](auto& row) {
+         row.shard   = shard;
+         row.account = *account;
       });
+   } else {
+      _routes.modify(route, get_self(), [&](auto& row) { row.account = *account; });
+   }
+}
+
+// @admin
+[[eosio::action]] bool drops::migrate(const name owner, const uint32_t limit)
+{
+   require_auth(get_self());
+   check(!is_enabled(get_self()), "Drops system must be disabled while migrating.");
+   check(limit > 0, "Limit must be a positive value.");
+
+   drops::balances_table  _balances(get_self(), get_self().value);
+   drops::migration_table _migration(get_self(), get_self().value);
+   drops::drop_table      _drops(get_self(), get_self().value);
+   drops::lock_table      _locks(get_self(), get_self().value);
+   auto&                  balance = _balances.get(owner.value, ERROR_OPEN_BALANCE.c_str());
+
+   // a migration of another owner restarts from the first drop
+   auto migration = _migration.get_or_default();
+   if (migration.owner != owner) {
+      migration = migration_row{owner};
+   }
+
+   const auto count = [&](const drop_row& drop) {
+      if (drop.bound) {
+         migration.bound++;
+      } else {
+         migration.unbound++;
+      }
+      if (_locks.find(drop.seed) != _locks.end()) {
+         migration.locked++;
+      }
+      migration.checksum ^= drop.seed;
+   };
+
+   // global totals count every drop, balances count the drops of the owner
+   uint32_t counted  = 0;
+   bool     complete = false;
+   if (owner == get_self()) {
+      auto itr = _drops.lower_bound(migration.cursor);
+      while (itr != _drops.end() && counted < limit) {
+         count(*itr);
+         counted++;
+         itr++;
+      }
+      complete = itr == _drops.end();
+      if (!complete) {
+         migration.cursor = itr->seed;
+      }
+   } else {
+      auto _drops_by_owner = _drops.get_index<"owner"_n>();
+      auto itr             = _drops_by_owner.lower_bound(combine_ids(owner.value, migration.cursor));
+      while (itr != _drops_by_owner.end() && itr->owner == owner && counted < limit) {
+         count(*itr);
+         counted++;
+         itr++;
+      }
+      complete = itr == _drops_by_owner.end() || itr->owner != owner;
+      if (!complete) {
+         migration.cursor = itr->seed;
+      }
+   }
+
+   if (!complete) {
+      _migration.set(migration, get_self());
+      return false;
+   }
+
+   // RAM of the extended balance is paid by the contract
+   _balances.modify(balance, get_self(), [&](auto& row) {
+      row.bound.emplace(migration.bound);
+      row.unbound.emplace(migration.unbound);
+      row.locked.emplace(migration.locked);
+      row.checksum.emplace(migration.checksum);
+      row.migrated.emplace(true);
+   });
+   _migration.remove();
+   return true;
+}
+
+void drops::record_changes(const uint8_t type, const vector<uint64_t>& seeds, const name owner)
+{
+   drops::journal_state_table _state(get_self(), get_self().value);
+   auto                       state = _state.get_or_default();
+   if (state.capacity == 0) {
+      return;
+   }
+   drops::journal_table _journal(get_self(), get_self().value);
+   for (const uint64_t seed : seeds) {
+      record_change(state, _journal, type, seed, owner);
+   }
+   _state.set(state, get_self());
+   trim_journal(state, _journal);
+}
+
+void drops::record_changes(const uint8_t type, const vector<drop_row>& drops)
+{
+   drops::journal_state_table _state(get_self(), get_self().value);
+   auto                       state = _state.get_or_default();
+   if (state.capacity == 0) {
+      return;
+   }
+   drops::journal_table _journal(get_self(), get_self().value);
+   for (const drop_row& drop : drops) {
+      record_change(state, _journal, type, drop.seed, drop.owner);
+   }
+   _state.set(state, get_self());
+   trim_journal(state, _journal);
+}
+
+void drops::record_change(
+   journal_state_row& state, journal_table& _journal, const uint8_t type, const uint64_t seed, const name owner)
+{
+   // overwrite the oldest change once the ring buffer is full
+   const uint64_t slot   = state.next % state.capacity;
+   const auto     writer = [&](auto& row) {
+      row.slot   = slot;
+      row.change = state.next;
+      row.seed   = seed;
+      row.type   = type;
+      row.owner  = owner;
+   };
+   auto itr = _journal.find(slot);
+   if (itr == _journal.end()) {
+      _journal.emplace(get_self(), writer);
+   } else {
+      _journal.modify(itr, same_payer, writer);
+   }
+   state.next++;
+}
+
+void drops::trim_journal(const journal_state_row& state, journal_table& _journal)
+{
+   // slots beyond the capacity are no longer written after the capacity was reduced
+   uint32_t released = 0;
+   auto     itr      = _journal.lower_bound(state.capacity);
+   while (itr != _journal.end() && released < MAX_JOURNAL_TRIM) {
+      itr = _journal.erase(itr);
+      released++;
+   }
+}
+
+bool drops::credit_inventory(const eosiosystem::ram_quote& quote, const asset quantity, const int64_t bytes)
+{
+   drops::inventory_table _inventory(get_self(), get_self().value);
+   auto                   inventory = _inventory.get_or_default();
+
+   // float must cover the credited bytes, otherwise RAM is purchased directly
+   // NOTE: each credit is capped at `max_pending` to bound the EOS exposed to the spot price of the RAM market
+   if (!inventory.enabled || inventory.bytes < bytes || quantity > inventory.max_pending) {
+      return false;
+   }
+   inventory.bytes -= bytes;
+   inventory.pending += quantity;
+
+   // settle when the float falls below or the pending EOS reaches the thresholds
+   if (inventory.bytes < inventory.min_bytes || inventory.pending >= inventory.max_pending) {
+      settle_inventory(quote, inventory);
+   }
+   _inventory.set(inventory, get_self());
+   return true;
+}
+
+bool drops::debit_inventory(const int64_t bytes, const asset quantity)
+{
+   drops::inventory_table _inventory(get_self(), get_self().value);
+   auto                   inventory = _inventory.get_or_default();
+
+   // pending EOS must cover the withdrawal, otherwise RAM is sold directly
+   if (!inventory.enabled || inventory.pending < quantity) {
+      return false;
    }
+   inventory.bytes += bytes;
+   inventory.pending -= quantity;
+   _inventory.set(inventory, get_self());
+   return true;
+}
+
+int64_t drops::settle_inventory(const eosiosystem::ram_quote& quote, inventory_row& inventory)
+{
+   if (inventory.pending.amount <= 0) {
+      return 0;
+   }
+   const int64_t bytes = quote.bytes_with_fee(inventory.pending);
+   buy_ram(inventory.pending);
+   inventory.bytes += bytes;
+   inventory.pending.amount = 0;
+   return bytes;
 }
 
 // @admin
@@ -589,4 +1704,97 @@ uint64_t drops::set_sequence(const int64_t amount)
    return state.sequence;
 }
 
+uint64_t drops::next_sequence(const name owner, const uint32_t amount)
+{
+   drops::reservation_table _reservations(get_self(), get_self().value);
+   auto                     reservation = _reservations.find(owner.value);
+
+   // without a reservation (or when the amount exceeds the reserved range), use the global sequence
+   // NOTE: the reserved range is left untouched and remains available for smaller generations
+   if (reservation == _reservations.end() || reservation->remaining < amount) {
+      const uint64_t sequence = get_sequence();
+      set_sequence(amount);
+      return sequence;
+   }
+
+   // use the sequence range reserved by the owner
+   const uint64_t sequence = reservation->sequence;
+   if (reservation->remaining == amount) {
+      _reservations.erase(reservation);
+   } else {
+      _reservations.modify(reservation, same_payer, [&](auto& row) {
+         row.sequence += amount;
+         row.remaining -= amount;
+      });
+   }
+   return sequence;
+}
+
+uint64_t drops::peek_sequence(const name owner, const uint32_t amount)
+{
+   drops::reservation_table _reservations(get_self(), get_self().value);
+   auto                     reservation = _reservations.find(owner.value);
+   if (reservation == _reservations.end() || reservation->remaining < amount) {
+      return get_sequence();
+   }
+   return reservation->sequence;
+}
+
+// @user
+[[eosio::action]] uint64_t drops::reserve(const name owner, const uint32_t amount)
+{
+   require_auth(owner);
+   check_is_enabled(get_self());
+   check(amount > 0, "The amount of sequences to reserve must be a positive value.");
+
+   drops::reservation_table _reservations(get_self(), get_self().value);
+   check(_reservations.find(owner.value) == _reservations.end(), "Account already has a reserved sequence range.");
+
+   const uint64_t sequence = get_sequence();
+   set_sequence(amount);
+   _reservations.emplace(owner, [&](auto& row) {
+      row.owner     = owner;
+      row.sequence  = sequence;
+      row.remaining = amount;
+   });
+   return sequence;
+}
+
+// @user
+[[eosio::action]] void drops::unreserve(const name owner)
+{
+   require_auth(owner);
+
+   drops::reservation_table _reservations(get_self(), get_self().value);
+   auto&                    reservation =
+      _reservations.get(owner.value, "Account does not have a reserved sequence range.");
+   _reservations.erase(reservation);
+}
+
+// @user
+[[eosio::action]] void drops::subscribe(const name owner, const uint8_t events)
+{
+   require_auth(owner);
+   check((events & ~NOTIFY_ALL) == 0, "Unknown notification events.");
+
+   drops::subscription_table _subscriptions(get_self(), get_self().value);
+   auto                      subscription = _subscriptions.find(owner.value);
+
+   // subscribing to all events is the default, the subscription is removed
+   if (events == NOTIFY_ALL) {
+      if (subscription != _subscriptions.end()) {
+         _subscriptions.erase(subscription);
+      }
+      return;
+   }
+   if (subscription == _subscriptions.end()) {
+      _subscriptions.emplace(owner, [&](auto& row) {
+         row.owner  = owner;
+         row.events = events;
+      });
+   } else {
+      _subscriptions.modify(subscription, owner, [&](auto& row) { row.events = events; });
+   }
+}
+
 } // namespace dropssystem
@@ -1,4 +1,4 @@
-import {Asset, Int64, Name} from '@wharfkit/antelope'
+import {ABISerializableConstructor, Asset, Int64, Name, Serializer} from '@wharfkit/antelope'
 import {TimePointSec} from '@greymass/eosio'
 import {Blockchain, expectToThrow} from '@proton/vert'
 import {beforeEach, describe, expect, test} from 'bun:test'
@@ -19,6 +19,8 @@ blockchain.createAccounts(bob, alice, charles, daniel)
 const core_contract = 'drops'
 const contracts = {
     core: blockchain.createContract(core_contract, `build/${core_contract}`, true),
+    autoclose: blockchain.createContract('autoclose', `build/${core_contract}.autoclose`, true),
+    shard: blockchain.createContract('shard', `build/${core_contract}`, true),
     token: blockchain.createContract('eosio.token', 'include/eosio.token/eosio.token', true),
     fake: blockchain.createContract('fake.token', 'include/eosio.token/eosio.token', true),
     system: blockchain.createContract('eosio', 'include/eosio.system/eosio', true),
@@ -45,6 +47,12 @@ function getTokenBalance(account: string) {
     return Asset.from(row.balance)
 }
 
+// return value of the last read-only action
+function getReturnValue<T>(type: ABISerializableConstructor): T {
+    const data = blockchain.actionTraces[0].returnValue
+    return Serializer.decode({data, type}) as T
+}
+
 function getBalance(owner: string) {
     const scope = Name.from(core_contract).value.value
     const primary_key = Name.from(owner).value.value
@@ -67,6 +75,18 @@ function getDrops(owner?: string): DropsContract.Types.drop_row[] {
     return rows.filter((row) => row.owner === owner)
 }
 
+function getJobs() {
+    const scope = Name.from(core_contract).value.value
+    return contracts.core.tables.job(scope).getTableRows()
+}
+
+function getInventory(): DropsContract.Types.inventory_row {
+    const scope = Name.from(core_contract).value.value
+    const row = contracts.core.tables.inventory(scope).getTableRows()[0]
+    if (!row) throw new Error('Inventory not found')
+    return DropsContract.Types.inventory_row.from(row)
+}
+
 function getRamBytes(account: string) {
     const scope = Name.from(account).value.value
     const row = contracts.system.tables
@@ -547,4 +567,1175 @@ describe(core_contract, () => {
             .send(bob)
         await expectToThrow(action, 'eosio_assert: Cannot transfer to contract.')
     })
+
+    test('destroyall', async () => {
+        await contracts.token.actions
+            .transfer([charles, core_contract, '10.0000 EOS', charles])
+            .send(charles)
+        const data = 'dddddddddddddddddddddddddddddddd'
+        await contracts.core.actions.generate([charles, false, 3, data]).send(charles)
+        const locked = String(getDrops(charles)[0].seed)
+        await contracts.core.actions.lock([charles, [locked]]).send(charles)
+
+        const before = getBalance(charles)
+        await contracts.core.actions.destroyall([charles, 10]).send(charles)
+        const after = getBalance(charles)
+
+        // locked drops should be skipped
+        expect(getDrops(charles).map((row) => String(row.seed))).toEqual([locked])
+        expect(after.drops.toNumber() - before.drops.toNumber()).toBe(-3)
+        expect(after.ram_bytes.toNumber() - before.ram_bytes.toNumber()).toBe(277 * 3)
+    })
+
+    test('destroyall::error - limit must be positive', async () => {
+        const action = contracts.core.actions.destroyall([charles, 0]).send(charles)
+        await expectToThrow(action, 'eosio_assert: The limit must be a positive value.')
+    })
+
+    test('transfermany', async () => {
+        const before = {
+            alice: getBalance(alice),
+            bob: getBalance(bob),
+            charles: getBalance(charles),
+            stat: getStat(),
+        }
+        const [drop1, drop2, drop3] = getDrops(alice).map((row) => String(row.seed))
+        await contracts.core.actions
+            .transfermany([
+                alice,
+                [
+                    {to: bob, droplet_ids: [drop1, drop2]},
+                    {to: charles, droplet_ids: [drop3]},
+                ],
+                '',
+            ])
+            .send(alice)
+        const after = {
+            alice: getBalance(alice),
+            bob: getBalance(bob),
+            charles: getBalance(charles),
+            stat: getStat(),
+        }
+
+        // drops should be transferred to each recipient
+        expect(getDrop(BigInt(drop1)).owner.toString()).toBe(bob)
+        expect(getDrop(BigInt(drop3)).owner.toString()).toBe(charles)
+        expect(after.alice.drops.toNumber() - before.alice.drops.toNumber()).toBe(-3)
+        expect(after.bob.drops.toNumber() - before.bob.drops.toNumber()).toBe(2)
+        expect(after.charles.drops.toNumber() - before.charles.drops.toNumber()).toBe(1)
+        expect(after.stat.drops.value - before.stat.drops.value).toBe(0)
+    })
+
+    test('transfermany::error - can not transfer to self', async () => {
+        const [drop_id] = getDrops(alice).map((row) => String(row.seed))
+        const action = contracts.core.actions
+            .transfermany([alice, [{to: alice, droplet_ids: [drop_id]}], ''])
+            .send(alice)
+        await expectToThrow(action, 'eosio_assert: Cannot transfer to self.')
+    })
+
+    test('airdrop', async () => {
+        const before = {
+            bob: getBalance(bob),
+            alice: getBalance(alice),
+            daniel: getBalance(daniel),
+            stat: getStat(),
+        }
+        const data = 'gggggggggggggggggggggggggggggggg'
+        await contracts.core.actions
+            .airdrop([
+                bob,
+                [
+                    {to: alice, amount: 2},
+                    {to: daniel, amount: 1},
+                ],
+                data,
+            ])
+            .send(bob)
+        const after = {
+            bob: getBalance(bob),
+            alice: getBalance(alice),
+            daniel: getBalance(daniel),
+            stat: getStat(),
+        }
+
+        // owner pays for all unbound drops
+        expect(after.bob.ram_bytes.toNumber() - before.bob.ram_bytes.toNumber()).toBe(-277 * 3)
+        expect(after.bob.drops.toNumber() - before.bob.drops.toNumber()).toBe(0)
+
+        // drops are generated directly into the recipient balances
+        expect(after.alice.drops.toNumber() - before.alice.drops.toNumber()).toBe(2)
+        expect(after.daniel.drops.toNumber() - before.daniel.drops.toNumber()).toBe(1)
+        expect(after.stat.drops.value - before.stat.drops.value).toBe(3)
+
+        // seeds follow the same sequence as generate
+        const sequence = getState().sequence.toNumber() - 3
+        const seed = toSeed([2, sequence + 2, data].join(''))
+        expect(getDrop(BigInt(seed.toString())).owner.toString()).toBe(daniel)
+        expect(getDrop(BigInt(seed.toString())).bound).toBeFalsy()
+    })
+
+    test('airdrop::error - no recipients', async () => {
+        const action = contracts.core.actions
+            .airdrop([bob, [], 'gggggggggggggggggggggggggggggggg'])
+            .send(bob)
+        await expectToThrow(action, 'eosio_assert: No recipients were provided.')
+    })
+
+    test('batch', async () => {
+        const before = {
+            bob: getBalance(bob),
+            alice: getBalance(alice),
+            stat: getStat(),
+        }
+        const unbound = getDrops(bob)
+            .filter((row) => !row.bound)
+            .map((row) => String(row.seed))
+        const bound = getDrops(bob)
+            .filter((row) => row.bound)
+            .map((row) => String(row.seed))
+        await contracts.core.actions
+            .batch([
+                bob,
+                [
+                    {action: 'lock', droplet_ids: [unbound[0]]},
+                    {action: 'transfer', droplet_ids: [unbound[1]], to: alice},
+                    {action: 'destroy', droplet_ids: [bound[0]]},
+                    {action: 'unbind', droplet_ids: [bound[1]]},
+                ],
+                'batch',
+            ])
+            .send(bob)
+        const after = {
+            bob: getBalance(bob),
+            alice: getBalance(alice),
+            stat: getStat(),
+        }
+
+        // balances are updated once for all operations
+        expect(after.bob.drops.toNumber() - before.bob.drops.toNumber()).toBe(-2)
+        expect(after.alice.drops.toNumber() - before.alice.drops.toNumber()).toBe(1)
+        expect(after.stat.drops.value - before.stat.drops.value).toBe(-1)
+        expect(after.bob.ram_bytes.toNumber() - before.bob.ram_bytes.toNumber()).toBe(-277)
+
+        // operations are applied to each drop
+        expect(getDrop(BigInt(unbound[1])).owner.toString()).toBe(alice)
+        expect(getDrop(BigInt(bound[1])).bound).toBeFalsy()
+        expect(() => getDrop(BigInt(bound[0]))).toThrow('Drop not found')
+        await expectToThrow(
+            contracts.core.actions.transfer([bob, alice, [unbound[0]], '']).send(bob),
+            `eosio_assert_message: Drop ${unbound[0]} is locked.`
+        )
+    })
+
+    test('batch::error - unknown operation', async () => {
+        const [drop_id] = getDrops(bob).map((row) => String(row.seed))
+        const action = contracts.core.actions
+            .batch([bob, [{action: 'foobar', droplet_ids: [drop_id]}], ''])
+            .send(bob)
+        await expectToThrow(action, 'eosio_assert: Unknown batch operation.')
+    })
+
+    test('on_transfer - generate', async () => {
+        const before = getBalance(bob)
+        const data = 'hhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhh'
+        await contracts.token.actions
+            .transfer([bob, core_contract, '1.0000 EOS', `generate,${bob},0,${data}`])
+            .send(bob)
+        const after = getBalance(bob)
+
+        // as many drops as the deposit covers, remaining bytes are credited
+        const generated = after.drops.toNumber() - before.drops.toNumber()
+        const remaining = after.ram_bytes.toNumber() - before.ram_bytes.toNumber()
+        expect(generated).toBeGreaterThan(0)
+        expect(remaining).toBeGreaterThanOrEqual(0)
+        expect(remaining).toBeLessThan(277)
+    })
+
+    test('on_transfer - generate amount', async () => {
+        const before = getBalance(bob)
+        const data = 'iiiiiiiiiiiiiiiiiiiiiiiiiiiiiiii'
+        await contracts.token.actions
+            .transfer([bob, core_contract, '1.0000 EOS', `generate,${bob},2,${data}`])
+            .send(bob)
+        const after = getBalance(bob)
+        expect(after.drops.toNumber() - before.drops.toNumber()).toBe(2)
+    })
+
+    test('on_transfer::error - generate invalid amount', async () => {
+        const data = 'iiiiiiiiiiiiiiiiiiiiiiiiiiiiiiii'
+        const action = contracts.token.actions
+            .transfer([bob, core_contract, '1.0000 EOS', `generate,${bob},foo,${data}`])
+            .send(bob)
+        await expectToThrow(action, 'eosio_assert: invalid number format or overflow')
+    })
+
+    test('destroyclaim', async () => {
+        const before = {
+            balance: getBalance(alice),
+            ram: getRamBytes(alice),
+        }
+        const [drop1, drop2] = getDrops(alice).map((row) => String(row.seed))
+        await contracts.core.actions.destroyclaim([alice, [drop1, drop2]]).send(alice)
+        const after = {
+            balance: getBalance(alice),
+            ram: getRamBytes(alice),
+        }
+
+        // reclaimed RAM bytes are sent directly to the owner
+        expect(after.ram - before.ram).toBe(277 * 2)
+        expect(after.balance.ram_bytes.toNumber() - before.balance.ram_bytes.toNumber()).toBe(0)
+        expect(after.balance.drops.toNumber() - before.balance.drops.toNumber()).toBe(-2)
+        expect(() => getDrop(BigInt(drop1))).toThrow('Drop not found')
+    })
+
+    test('destroyclaim - receiver', async () => {
+        const before = getRamBytes(bob)
+        const [drop_id] = getDrops(alice).map((row) => String(row.seed))
+        await contracts.core.actions.destroyclaim([alice, [drop_id], bob]).send(alice)
+        expect(getRamBytes(bob) - before).toBe(277)
+    })
+
+    test('jobcreate', async () => {
+        const before = getBalance(bob)
+        const data = 'jjjjjjjjjjjjjjjjjjjjjjjjjjjjjjjj'
+        await contracts.core.actions.jobcreate([bob, false, 5, data]).send(bob)
+        const after = getBalance(bob)
+
+        // RAM bytes are reserved up front, no drops are generated yet
+        expect(after.ram_bytes.toNumber() - before.ram_bytes.toNumber()).toBe(-277 * 5)
+        expect(after.drops.toNumber() - before.drops.toNumber()).toBe(0)
+        expect(getJobs().length).toBe(1)
+    })
+
+    test('jobcontinue', async () => {
+        const [job] = getJobs()
+        const before = getBalance(bob)
+        await contracts.core.actions.jobcontinue([bob, job.id, 3]).send(bob)
+        expect(getBalance(bob).drops.toNumber() - before.drops.toNumber()).toBe(3)
+        expect(getJobs()[0].generated).toBe(3)
+
+        await contracts.core.actions.jobcontinue([bob, job.id, 10]).send(bob)
+        const after = getBalance(bob)
+        expect(after.drops.toNumber() - before.drops.toNumber()).toBe(5)
+        expect(after.ram_bytes.toNumber() - before.ram_bytes.toNumber()).toBe(0)
+
+        // job is removed once completed, seeds match a single generate
+        expect(getJobs().length).toBe(0)
+        const seed = toSeed([4, Number(job.sequence) + 4, job.data].join(''))
+        expect(getDrop(BigInt(seed.toString())).owner.toString()).toBe(bob)
+    })
+
+    test('jobcancel', async () => {
+        const before = getBalance(bob)
+        const data = 'kkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkk'
+        await contracts.core.actions.jobcreate([bob, false, 5, data]).send(bob)
+        const [job] = getJobs()
+        await contracts.core.actions.jobcontinue([bob, job.id, 2]).send(bob)
+        await contracts.core.actions.jobcancel([bob, job.id]).send(bob)
+        const after = getBalance(bob)
+
+        // reserved RAM bytes of drops not generated are returned
+        expect(after.ram_bytes.toNumber() - before.ram_bytes.toNumber()).toBe(-277 * 2)
+        expect(after.drops.toNumber() - before.drops.toNumber()).toBe(2)
+        expect(getJobs().length).toBe(0)
+    })
+
+    test('jobcontinue::error - not found', async () => {
+        const action = contracts.core.actions.jobcontinue([bob, 123, 1]).send(bob)
+        await expectToThrow(action, 'eosio_assert: Job not found.')
+    })
+
+    test('generatesafe - skip', async () => {
+        // reset the sequence to generate colliding seeds
+        const data = 'llllllllllllllllllllllllllllllll'
+        await contracts.core.actions.cleartable(['state']).send()
+        await contracts.core.actions.enable([true]).send()
+        await contracts.core.actions.generate([bob, false, 1, data]).send(bob)
+        await contracts.core.actions.cleartable(['state']).send()
+        await contracts.core.actions.enable([true]).send()
+
+        const before = getBalance(bob)
+        await contracts.core.actions.generatesafe([bob, false, 2, data, 'skip']).send(bob)
+        const after = getBalance(bob)
+
+        // colliding drop is skipped and does not consume RAM bytes
+        expect(after.drops.toNumber() - before.drops.toNumber()).toBe(1)
+        expect(after.ram_bytes.toNumber() - before.ram_bytes.toNumber()).toBe(-277)
+    })
+
+    test('generatesafe - resalt', async () => {
+        // both seeds already exist from the previous test
+        const data = 'llllllllllllllllllllllllllllllll'
+        await contracts.core.actions.cleartable(['state']).send()
+        await contracts.core.actions.enable([true]).send()
+
+        const before = getBalance(bob)
+        await contracts.core.actions.generatesafe([bob, false, 2, data, 'resalt']).send(bob)
+        const after = getBalance(bob)
+
+        // colliding drops are generated with new seeds
+        expect(after.drops.toNumber() - before.drops.toNumber()).toBe(2)
+        expect(after.ram_bytes.toNumber() - before.ram_bytes.toNumber()).toBe(-277 * 2)
+    })
+
+    test('generatesafe::error - invalid collision mode', async () => {
+        const data = 'llllllllllllllllllllllllllllllll'
+        const action = contracts.core.actions.generatesafe([bob, false, 2, data, 'foo']).send(bob)
+        await expectToThrow(action, 'eosio_assert: Collision mode must be "resalt" or "skip".')
+    })
+
+    test('reserve', async () => {
+        const data = 'mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.reserve([bob, 10]).send(bob)
+        await contracts.core.actions.generate([alice, false, 1, data]).send(alice)
+        const after = getState().sequence.toNumber()
+
+        // other accounts generate after the reserved range
+        expect(after - sequence).toBe(11)
+
+        // reserved range is used by the owner and does not move the global sequence
+        await contracts.core.actions.generate([bob, false, 2, data]).send(bob)
+        expect(getState().sequence.toNumber()).toBe(after)
+        const seed = toSeed([1, sequence + 1, data].join(''))
+        expect(getDrop(BigInt(seed.toString())).owner.toString()).toBe(bob)
+    })
+
+    test('reserve::error - already reserved', async () => {
+        const action = contracts.core.actions.reserve([bob, 10]).send(bob)
+        await expectToThrow(action, 'eosio_assert: Account already has a reserved sequence range.')
+    })
+
+    test('reserve - amount exceeds reserved range', async () => {
+        const data = 'nnnnnnnnnnnnnnnnnnnnnnnnnnnnnnnn'
+        const scope = Name.from(core_contract).value.value
+        const primary_key = Name.from(bob).value.value
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([bob, false, 9, data]).send(bob)
+
+        // global sequence is used, the reserved range remains available
+        expect(getState().sequence.toNumber() - sequence).toBe(9)
+        const reservation = contracts.core.tables.reservation(scope).getTableRow(primary_key)
+        expect(Number(reservation.remaining)).toBe(8)
+    })
+
+    test('unreserve', async () => {
+        await contracts.core.actions.unreserve([bob]).send(bob)
+        const action = contracts.core.actions.unreserve([bob]).send(bob)
+        await expectToThrow(
+            action,
+            'eosio_assert: Account does not have a reserved sequence range.'
+        )
+    })
+
+    test('generateopts - locked recipient', async () => {
+        const data = 'oooooooooooooooooooooooooooooooo'
+        const sequence = getState().sequence.toNumber()
+        const before_bob = getBalance(bob)
+        const before_alice = getBalance(alice)
+        await contracts.core.actions.generateopts([bob, false, 2, data, true, alice]).send(bob)
+        const after_bob = getBalance(bob)
+        const after_alice = getBalance(alice)
+
+        // RAM bytes are paid by the owner, drops are received by the recipient
+        expect(after_bob.ram_bytes.toNumber() - before_bob.ram_bytes.toNumber()).toBe(-277 * 2)
+        expect(after_bob.drops.toNumber() - before_bob.drops.toNumber()).toBe(0)
+        expect(after_alice.drops.toNumber() - before_alice.drops.toNumber()).toBe(2)
+
+        // drops are generated locked
+        const seed = toSeed([0, sequence, data].join(''))
+        expect(getDrop(BigInt(seed.toString())).owner.toString()).toBe(alice)
+        const action = contracts.core.actions.transfer([alice, bob, [seed]]).send(alice)
+        await expectToThrow(action, `eosio_assert_message: Drop ${seed} is locked.`)
+    })
+
+    test('generateopts::error - bound recipient', async () => {
+        const data = 'pppppppppppppppppppppppppppppppp'
+        const action = contracts.core.actions
+            .generateopts([bob, true, 1, data, false, alice])
+            .send(bob)
+        await expectToThrow(
+            action,
+            'eosio_assert: Bound drops cannot be generated for another account.'
+        )
+    })
+
+    test('inventory - credit deposits from the float', async () => {
+        // float is backed by RAM purchased for the contract
+        await contracts.system.actions.buyrambytes([alice, core_contract, 110000]).send(alice)
+        await contracts.core.actions.setinventory([true, 0, '10.0000 EOS']).send()
+        await contracts.core.actions.addinventory([100000]).send()
+
+        const before = getBalance(bob)
+        const before_contract = getRamBytes(core_contract)
+        await contracts.token.actions.transfer([bob, core_contract, '1.0000 EOS', bob]).send(bob)
+        const after = getBalance(bob)
+        const inventory = getInventory()
+
+        // RAM bytes are credited from the float without purchasing RAM
+        const bytes = after.ram_bytes.toNumber() - before.ram_bytes.toNumber()
+        expect(bytes).toBeGreaterThan(0)
+        expect(inventory.bytes.toNumber()).toBe(100000 - bytes)
+        expect(String(inventory.pending)).toBe('1.0000 EOS')
+        expect(getRamBytes(core_contract)).toBe(before_contract)
+    })
+
+    test('inventory - settle', async () => {
+        const before_contract = getRamBytes(core_contract)
+        await contracts.core.actions.settle([]).send(bob)
+        const inventory = getInventory()
+
+        // pending EOS is used to purchase RAM bytes into the float
+        expect(String(inventory.pending)).toBe('0.0000 EOS')
+        expect(getRamBytes(core_contract)).toBeGreaterThan(before_contract)
+        expect(inventory.bytes.toNumber()).toBeGreaterThan(100000 - 1000)
+    })
+
+    test('inventory - deposits above the maximum pending purchase RAM', async () => {
+        const before = getInventory()
+        const before_contract = getRamBytes(core_contract)
+        await contracts.token.actions.transfer([bob, core_contract, '11.0000 EOS', bob]).send(bob)
+
+        // credit is capped at the maximum pending, the float is not used
+        expect(getInventory().bytes.toNumber()).toBe(before.bytes.toNumber())
+        expect(String(getInventory().pending)).toBe(String(before.pending))
+        expect(getRamBytes(core_contract)).toBeGreaterThan(before_contract)
+    })
+
+    test('inventory - settle when the float falls below minimum', async () => {
+        const before = getInventory()
+        await contracts.core.actions
+            .setinventory([true, before.bytes.toNumber(), '10.0000 EOS'])
+            .send()
+        const before_contract = getRamBytes(core_contract)
+        await contracts.token.actions.transfer([bob, core_contract, '1.0000 EOS', bob]).send(bob)
+
+        expect(String(getInventory().pending)).toBe('0.0000 EOS')
+        expect(getRamBytes(core_contract)).toBeGreaterThan(before_contract)
+        await contracts.core.actions.setinventory([false, 0, '0.0000 EOS']).send()
+    })
+
+    test('addinventory::error - negative float', async () => {
+        const action = contracts.core.actions.addinventory([-100000000]).send()
+        await expectToThrow(action, 'eosio_assert: Inventory bytes cannot be negative.')
+    })
+
+    test('ramcurve', async () => {
+        await contracts.core.actions.ramcurve([[1000], ['1.0000 EOS'], 277, 554, 277]).send(bob)
+        const result = getReturnValue<DropsContract.Types.ramcurve_return_value>(
+            DropsContract.Types.ramcurve_return_value
+        )
+
+        // byte amounts followed by the range, each covering whole drops
+        expect(result.bytes.map((quote) => quote.bytes.toNumber())).toEqual([1000, 277, 554])
+        expect(result.bytes.map((quote) => quote.drops.toNumber())).toEqual([3, 1, 2])
+
+        // quotes match the single amount quotes
+        const costs: string[] = []
+        for (const bytes of [1000, 277, 554]) {
+            await contracts.core.actions.ramcost([bytes]).send(bob)
+            costs.push(String(getReturnValue<Asset>(Asset)))
+        }
+        expect(result.bytes.map((quote) => String(quote.cost))).toEqual(costs)
+
+        await contracts.core.actions.bytescost(['1.0000 EOS']).send(bob)
+        const bytes = getReturnValue<Int64>(Int64).toNumber()
+        expect(result.quantities[0].bytes.toNumber()).toBe(bytes)
+        expect(result.quantities[0].drops.toNumber()).toBe(Math.floor(bytes / 277))
+    })
+
+    test('ramcurve - range ending at the int64 maximum', async () => {
+        const to = '9223372036854775807'
+        await contracts.core.actions.ramcurve([[], [], '9223372036854775000', to, 500]).send(bob)
+        const result = getReturnValue<DropsContract.Types.ramcurve_return_value>(
+            DropsContract.Types.ramcurve_return_value
+        )
+
+        // range stops at the last step below `to` without overflowing
+        expect(result.bytes.map((quote) => String(quote.bytes))).toEqual([
+            '9223372036854775000',
+            '9223372036854775500',
+        ])
+    })
+
+    test('ramcurve::error - too many quotes', async () => {
+        const action = contracts.core.actions.ramcurve([[], [], 1, 1000000, 1]).send(bob)
+        await expectToThrow(action, 'eosio_assert: Too many quotes requested.')
+    })
+
+    test('ownerdrops::error - limit', async () => {
+        const action = contracts.core.actions.ownerdrops([bob, 0]).send(bob)
+        await expectToThrow(
+            action,
+            'eosio_assert: The limit must be a positive value within the maximum.'
+        )
+    })
+
+    test('ownerdrops - pagination', async () => {
+        const seeds = getDrops(bob)
+            .map((drop) => BigInt(drop.seed.toString()))
+            .sort((a, b) => (a < b ? -1 : a > b ? 1 : 0))
+        const toSeeds = (result: DropsContract.Types.ownerdrops_return_value) =>
+            result.seeds.map((seed) => BigInt(seed.toString()))
+
+        // first page returns the cursor of the next drop
+        await contracts.core.actions.ownerdrops([bob, 2, null]).send(bob)
+        const first = getReturnValue<DropsContract.Types.ownerdrops_return_value>(
+            DropsContract.Types.ownerdrops_return_value
+        )
+        expect(toSeeds(first)).toEqual(seeds.slice(0, 2))
+        expect(first.flags.length).toBe(2)
+        expect(BigInt(first.next_cursor.toString())).toBe(seeds[2])
+
+        // next page resumes from the cursor
+        await contracts.core.actions.ownerdrops([bob, 2, first.next_cursor]).send(bob)
+        const second = getReturnValue<DropsContract.Types.ownerdrops_return_value>(
+            DropsContract.Types.ownerdrops_return_value
+        )
+        expect(toSeeds(second)).toEqual(seeds.slice(2, 4))
+
+        // last page has no cursor
+        await contracts.core.actions.ownerdrops([bob, seeds.length, null]).send(bob)
+        const all = getReturnValue<DropsContract.Types.ownerdrops_return_value>(
+            DropsContract.Types.ownerdrops_return_value
+        )
+        expect(toSeeds(all)).toEqual(seeds)
+        expect(all.next_cursor).toBeUndefined()
+    })
+
+    test('dropsinfo::error - no drops', async () => {
+        const action = contracts.core.actions.dropsinfo([[]]).send(bob)
+        await expectToThrow(action, ERROR_NO_DROPS)
+    })
+
+    test('balances - bound, unbound & locked counters', async () => {
+        const data = 'qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([bob, false, 2, data]).send(bob)
+        const seed = toSeed([0, sequence, data].join(''))
+
+        const before = getBalance(bob)
+        await contracts.core.actions.bind([bob, [seed]]).send(bob)
+        await contracts.core.actions.lock([bob, [seed]]).send(bob)
+        const after = getBalance(bob)
+        expect(after.bound.toNumber() - before.bound.toNumber()).toBe(1)
+        expect(after.unbound.toNumber() - before.unbound.toNumber()).toBe(-1)
+        expect(after.locked.toNumber() - before.locked.toNumber()).toBe(1)
+
+        // counters always add up to the drops balance, including the global totals
+        for (const owner of [bob, alice, charles, core_contract]) {
+            const balance = getBalance(owner)
+            expect(balance.bound.toNumber() + balance.unbound.toNumber()).toBe(
+                balance.drops.toNumber()
+            )
+        }
+    })
+
+    test('dropsinfo - validity bitmap', async () => {
+        const data = 'dropsinfodropsinfodropsinfodrops'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([bob, false, 4, data]).send(bob)
+        const seeds = [0, 1, 2, 3].map((index) => toSeed([index, sequence + index, data].join('')))
+        await contracts.core.actions.bind([bob, [seeds[1]]]).send(bob)
+        await contracts.core.actions.lock([bob, [seeds[2]]]).send(bob)
+
+        // bound, locked and missing drops are not valid
+        const ids = [seeds[0], seeds[1], seeds[2], 1, seeds[3]]
+        await contracts.core.actions.dropsinfo([ids, bob, false]).send(bob)
+        const result = getReturnValue<DropsContract.Types.dropsinfo_return_value>(
+            DropsContract.Types.dropsinfo_return_value
+        )
+        expect(result.valid.map(Number)).toEqual([0b10001])
+        expect(result.drops.map((drop) => drop.bound)).toEqual([false, true, false, false, false])
+        expect(result.drops.map((drop) => drop.locked)).toEqual([false, false, true, false, false])
+        expect(result.drops.map((drop) => String(drop.owner))).toEqual([bob, bob, bob, '', bob])
+
+        // compact result only returns the bitmap
+        await contracts.core.actions.dropsinfo([ids, bob, true]).send(bob)
+        const compact = getReturnValue<DropsContract.Types.dropsinfo_return_value>(
+            DropsContract.Types.dropsinfo_return_value
+        )
+        expect(compact.drops.length).toBe(0)
+        expect(compact.valid.map(Number)).toEqual([0b10001])
+
+        // drops of another owner are not valid
+        await contracts.core.actions.dropsinfo([ids, alice, true]).send(bob)
+        const other = getReturnValue<DropsContract.Types.dropsinfo_return_value>(
+            DropsContract.Types.dropsinfo_return_value
+        )
+        expect(other.valid.map(Number)).toEqual([0])
+    })
+
+    test('balances - counters after unlock, unbind & destroy', async () => {
+        const data = 'counterscounterscounterscounters'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([bob, true, 2, data]).send(bob)
+        const seeds = [0, 1].map((index) => toSeed([index, sequence + index, data].join('')))
+        await contracts.core.actions.lock([bob, [seeds[0]]]).send(bob)
+
+        let before = getBalance(bob)
+        await contracts.core.actions.unlock([bob, [seeds[0]]]).send(bob)
+        let after = getBalance(bob)
+        expect(after.locked.toNumber() - before.locked.toNumber()).toBe(-1)
+
+        before = after
+        await contracts.core.actions.unbind([bob, [seeds[0]]]).send(bob)
+        after = getBalance(bob)
+        expect(after.bound.toNumber() - before.bound.toNumber()).toBe(-1)
+        expect(after.unbound.toNumber() - before.unbound.toNumber()).toBe(1)
+
+        // one unbound and one bound drop destroyed
+        before = after
+        const before_totals = getBalance(core_contract)
+        await contracts.core.actions.destroy([bob, seeds, '']).send(bob)
+        after = getBalance(bob)
+        const after_totals = getBalance(core_contract)
+        expect(after.bound.toNumber() - before.bound.toNumber()).toBe(-1)
+        expect(after.unbound.toNumber() - before.unbound.toNumber()).toBe(-1)
+        expect(after_totals.bound.toNumber() - before_totals.bound.toNumber()).toBe(-1)
+        expect(after_totals.unbound.toNumber() - before_totals.unbound.toNumber()).toBe(-1)
+        expect(after.bound.toNumber() + after.unbound.toNumber()).toBe(after.drops.toNumber())
+    })
+
+    test('stats', async () => {
+        await contracts.core.actions.stats([bob]).send(bob)
+        const result = getReturnValue<DropsContract.Types.stats_return_value>(
+            DropsContract.Types.stats_return_value
+        )
+
+        // balance of the owner with the global totals
+        const balance = getBalance(bob)
+        const totals = getBalance(core_contract)
+        expect(String(result.balance.owner)).toBe(bob)
+        expect(result.balance.drops.toNumber()).toBe(balance.drops.toNumber())
+        expect(result.balance.locked.toNumber()).toBe(balance.locked.toNumber())
+        expect(String(result.totals.owner)).toBe(core_contract)
+        expect(result.totals.drops.toNumber()).toBe(totals.drops.toNumber())
+        expect(result.totals.bound.toNumber()).toBe(totals.bound.toNumber())
+    })
+
+    test('stats::error - balance not open', async () => {
+        const action = contracts.core.actions.stats(['eosio.token']).send(bob)
+        await expectToThrow(action, ERROR_OPEN_BALANCE)
+    })
+
+    test('migrate', async () => {
+        const scope = Name.from(core_contract).value.value
+        const before = getBalance(bob)
+        const before_totals = getBalance(core_contract)
+        await contracts.core.actions.enable([false]).send()
+
+        // progress is kept between steps
+        await contracts.core.actions.migrate([bob, 1]).send()
+        const migration = contracts.core.tables.migration(scope).getTableRows()[0]
+        expect(String(migration.owner)).toBe(bob)
+        expect(Number(migration.bound) + Number(migration.unbound)).toBe(1)
+
+        // recounted counters match the maintained counters
+        await contracts.core.actions.migrate([bob, 10000]).send()
+        await contracts.core.actions.migrate([core_contract, 10000]).send()
+        expect(contracts.core.tables.migration(scope).getTableRows().length).toBe(0)
+        for (const [after, expected] of [
+            [getBalance(bob), before],
+            [getBalance(core_contract), before_totals],
+        ]) {
+            expect(after.bound.toNumber()).toBe(expected.bound.toNumber())
+            expect(after.unbound.toNumber()).toBe(expected.unbound.toNumber())
+            expect(after.locked.toNumber()).toBe(expected.locked.toNumber())
+            expect(String(after.checksum)).toBe(String(expected.checksum))
+        }
+    })
+
+    test('migrate::error - system enabled', async () => {
+        const action = contracts.core.actions.migrate([bob, 100]).send()
+        await expectToThrow(action, 'eosio_assert: Drops system must be disabled while migrating.')
+    })
+
+    test('simulate::error - preview exceeds amount', async () => {
+        const data = 'rrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrr'
+        const action = contracts.core.actions.simulate([bob, false, 1, data, 2]).send(bob)
+        await expectToThrow(
+            action,
+            'eosio_assert: Preview must be within the amount and the maximum.'
+        )
+    })
+
+    test('simulate', async () => {
+        const data = 'simulatesimulatesimulatesimulate'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.simulate([bob, false, 3, data, 3]).send(bob)
+        const result = getReturnValue<DropsContract.Types.simulate_return_value>(
+            DropsContract.Types.simulate_return_value
+        )
+        expect(result.sequence.toNumber()).toBe(sequence)
+        expect(result.bytes_required.toNumber()).toBe(277 * 3)
+        expect(result.collisions.length).toBe(0)
+
+        // predicted seeds are the seeds generated next
+        await contracts.core.actions.generate([bob, false, 3, data]).send(bob)
+        const seeds = result.seeds.map((seed) => BigInt(seed.toString()))
+        const expected = [0, 1, 2].map((index) =>
+            toSeed([index, sequence + index, data].join('')).toString()
+        )
+        expect(seeds).toEqual(expected.map(BigInt))
+        for (const seed of seeds) {
+            expect(getDrop(seed).owner.toString()).toBe(bob)
+        }
+    })
+
+    test('journal - ring buffer', async () => {
+        const scope = Name.from(core_contract).value.value
+        const data = 'ssssssssssssssssssssssssssssssss'
+        await contracts.core.actions.setjournal([2]).send()
+        await contracts.core.actions.generate([bob, false, 3, data]).send(bob)
+
+        // oldest change is overwritten once the ring buffer is full
+        const rows = contracts.core.tables.journal(scope).getTableRows()
+        expect(rows.length).toBe(2)
+        expect(rows.map((row) => Number(row.change)).sort()).toEqual([1, 2])
+        expect(rows.every((row) => Number(row.type) === 0 && String(row.owner) === bob)).toBe(true)
+
+        await contracts.core.actions.setjournal([0]).send()
+        expect(contracts.core.tables.journal(scope).getTableRows().length).toBe(0)
+    })
+
+    test('changes', async () => {
+        const scope = Name.from(core_contract).value.value
+        const data = 'changeschangeschangeschangeschan'
+        await contracts.core.actions.setjournal([10]).send()
+        const since = Number(contracts.core.tables.journalstate(scope).getTableRows()[0].next)
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([bob, false, 2, data]).send(bob)
+        const seeds = [0, 1].map((index) =>
+            BigInt(toSeed([index, sequence + index, data].join('')).toString())
+        )
+        await contracts.core.actions.transfer([bob, alice, [seeds[0]], '']).send(bob)
+
+        // changes are returned in order with the owner after each change
+        await contracts.core.actions.changes([since, 10]).send(bob)
+        const result = getReturnValue<DropsContract.Types.changes_return_value>(
+            DropsContract.Types.changes_return_value
+        )
+        expect(result.behind).toBe(false)
+        expect(result.next.toNumber()).toBe(since + 3)
+        expect(result.changes.map((change) => Number(change.type))).toEqual([0, 0, 2])
+        const changed = result.changes.map((change) => BigInt(change.seed.toString()))
+        expect(changed).toEqual([seeds[0], seeds[1], seeds[0]])
+        expect(result.changes.map((change) => String(change.owner))).toEqual([bob, bob, alice])
+
+        // nothing left to return from the next change number
+        await contracts.core.actions.changes([result.next, 10]).send(bob)
+        const next = getReturnValue<DropsContract.Types.changes_return_value>(
+            DropsContract.Types.changes_return_value
+        )
+        expect(next.changes.length).toBe(0)
+
+        // slots beyond a reduced capacity are released
+        await contracts.core.actions.setjournal([1]).send()
+        const rows = contracts.core.tables.journal(scope).getTableRows()
+        expect(rows.every((row) => Number(row.slot) < 1)).toBe(true)
+        await contracts.core.actions.setjournal([0]).send()
+    })
+
+    test('balances - seed checksum', async () => {
+        const data = 'tttttttttttttttttttttttttttttttt'
+        const sequence = getState().sequence.toNumber()
+        const before = BigInt(getBalance(bob).checksum.toString())
+        await contracts.core.actions.generate([bob, false, 2, data]).send(bob)
+        const seeds = [0, 1].map((index) =>
+            BigInt(toSeed([index, sequence + index, data].join('')).toString())
+        )
+
+        // checksum is the XOR of the seeds, every change toggles the seeds in and out
+        const after = BigInt(getBalance(bob).checksum.toString())
+        expect(before ^ after).toBe(seeds[0] ^ seeds[1])
+
+        await contracts.core.actions.transfer([bob, alice, [seeds[0]], '']).send(bob)
+        const transferred = BigInt(getBalance(bob).checksum.toString())
+        expect(transferred ^ after).toBe(seeds[0])
+
+        // checksum returned by the read-only action
+        await contracts.core.actions.checksum([bob]).send(bob)
+        const result = getReturnValue<DropsContract.Types.checksum_return_value>(
+            DropsContract.Types.checksum_return_value
+        )
+        expect(BigInt(result.checksum.toString())).toBe(transferred)
+        expect(result.drops.toNumber()).toBe(getBalance(bob).drops.toNumber())
+
+        // destroyed seeds are toggled out of the owner and the global totals
+        const totals = BigInt(getBalance(core_contract).checksum.toString())
+        await contracts.core.actions.destroy([bob, [seeds[1]], '']).send(bob)
+        expect(BigInt(getBalance(bob).checksum.toString()) ^ transferred).toBe(seeds[1])
+        expect(BigInt(getBalance(core_contract).checksum.toString()) ^ totals).toBe(seeds[1])
+    })
+
+    test('checksum::error - balance not open', async () => {
+        const action = contracts.core.actions.checksum(['eosio.token']).send(bob)
+        await expectToThrow(action, ERROR_OPEN_BALANCE)
+    })
+
+    test('close', async () => {
+        blockchain.createAccounts('erin')
+        await contracts.core.actions.open(['erin']).send('erin')
+        await contracts.core.actions.close(['erin']).send('erin')
+        expect(() => getBalance('erin')).toThrow('Balance not found')
+    })
+
+    test('close::error - balance not empty', async () => {
+        const action = contracts.core.actions.close([bob]).send(bob)
+        await expectToThrow(
+            action,
+            'eosio_assert: Balance must not have any drops or RAM bytes to be closed.'
+        )
+    })
+
+    test('sweep::error - missing required authority', async () => {
+        // balance opened by its owner ahead of a deposit cannot be closed by others
+        blockchain.createAccounts('frank', 'grace')
+        await contracts.core.actions.open(['frank']).send('frank')
+        const action = contracts.core.actions.sweep([1000]).send(bob)
+        await expectToThrow(action, `missing required authority ${core_contract}`)
+        expect(getBalance('frank').drops.toNumber()).toBe(0)
+    })
+
+    test('sweep', async () => {
+        await contracts.core.actions.open(['grace']).send('grace')
+        await contracts.core.actions.sweep([1000]).send()
+
+        // only empty balances are closed
+        expect(() => getBalance('frank')).toThrow('Balance not found')
+        expect(() => getBalance('grace')).toThrow('Balance not found')
+        expect(getBalance(bob).drops.toNumber()).toBeGreaterThan(0)
+        expect(getBalance(core_contract).drops.toNumber()).toBeGreaterThan(0)
+    })
+
+    test('sweep::error - contract disabled', async () => {
+        await contracts.core.actions.enable([false]).send()
+        const action = contracts.core.actions.sweep([1000]).send()
+        await expectToThrow(action, ERROR_SYSTEM_DISABLED)
+    })
+
+    test('auto-close balances', async () => {
+        // deployment built with `AUTO_CLOSE_BALANCES`
+        const autoclose = contracts.autoclose
+        const scope = Name.from('autoclose').value.value
+        const primary_key = Name.from(alice).value.value
+        await autoclose.actions.enable([true]).send()
+        await autoclose.actions.open([alice]).send(alice)
+        await contracts.token.actions
+            .transfer([alice, 'autoclose', '1.0000 EOS', alice])
+            .send(alice)
+        const balance = autoclose.tables.balances(scope).getTableRow(primary_key)
+        expect(Number(balance.ram_bytes)).toBeGreaterThan(0)
+
+        // balance emptied by the claim is closed, the contract balance is kept
+        await autoclose.actions.claim([alice]).send(alice)
+        expect(autoclose.tables.balances(scope).getTableRow(primary_key)).toBeUndefined()
+        expect(autoclose.tables.balances(scope).getTableRow(scope)).toBeDefined()
+    })
+
+    test('subscribe', async () => {
+        const scope = Name.from(core_contract).value.value
+        const primary_key = Name.from(bob).value.value
+        await contracts.core.actions.subscribe([bob, 16]).send(bob)
+        const subscription = contracts.core.tables.subscription(scope).getTableRow(primary_key)
+        expect(Number(subscription.events)).toBe(16)
+
+        // subscribing to all events removes the subscription
+        await contracts.core.actions.subscribe([bob, 31]).send(bob)
+        expect(contracts.core.tables.subscription(scope).getTableRow(primary_key)).toBeUndefined()
+    })
+
+    test('subscribe::error - unknown events', async () => {
+        const action = contracts.core.actions.subscribe([bob, 32]).send(bob)
+        await expectToThrow(action, 'eosio_assert: Unknown notification events.')
+    })
+
+    test('subscribe - notifications', async () => {
+        const data = 'notifynotifynotifynotifynotifyno'
+        const recipient = 'fake.token'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([bob, false, 2, data]).send(bob)
+        const seeds = [0, 1].map((index) =>
+            BigInt(toSeed([index, sequence + index, data].join('')).toString())
+        )
+        const notified = () =>
+            blockchain.actionTraces.filter((trace) => String(trace.receiver) === recipient)
+
+        // unsubscribed events are not notified
+        await contracts.core.actions.subscribe([recipient, 4]).send(recipient)
+        await contracts.core.actions.transfer([bob, recipient, [seeds[0]], '']).send(bob)
+        expect(getDrop(seeds[0]).owner.toString()).toBe(recipient)
+        expect(notified().length).toBe(0)
+
+        // subscribed events are notified
+        await contracts.core.actions.subscribe([recipient, 16]).send(recipient)
+        await contracts.core.actions.transfer([bob, recipient, [seeds[1]], '']).send(bob)
+        expect(notified().length).toBeGreaterThan(0)
+        await contracts.core.actions.subscribe([recipient, 31]).send(recipient)
+    })
+
+    test('transferfrom', async () => {
+        const data = 'uuuuuuuuuuuuuuuuuuuuuuuuuuuuuuuu'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([bob, false, 2, data]).send(bob)
+        const seeds = [0, 1].map((index) =>
+            BigInt(toSeed([index, sequence + index, data].join('')).toString())
+        )
+        await contracts.core.actions.approve([bob, alice, 2]).send(bob)
+
+        const before = getBalance(bob)
+        await contracts.core.actions
+            .transferfrom([alice, [{from: bob, to: charles, droplet_ids: [seeds[0]]}], null])
+            .send(alice)
+        expect(getDrop(seeds[0]).owner.toString()).toBe(charles)
+        expect(getBalance(bob).drops.toNumber() - before.drops.toNumber()).toBe(-1)
+
+        // approval is consumed and removed once exhausted
+        const scope = Name.from(core_contract).value.value
+        const approvals = () => contracts.core.tables.approval(scope).getTableRows()
+        expect(Number(approvals()[0].remaining)).toBe(1)
+        await contracts.core.actions
+            .transferfrom([alice, [{from: bob, to: charles, droplet_ids: [seeds[1]]}], null])
+            .send(alice)
+        expect(approvals().length).toBe(0)
+    })
+
+    test('approve - unlimited', async () => {
+        const scope = Name.from(core_contract).value.value
+        await contracts.core.actions.approve([bob, daniel, null]).send(bob)
+        const [approval] = contracts.core.tables.approval(scope).getTableRows()
+        expect(String(approval.approved)).toBe(daniel)
+        expect(Number(approval.remaining)).toBe(0)
+        await contracts.core.actions.unapprove([bob, daniel]).send(bob)
+    })
+
+    test('approve::error - zero limit', async () => {
+        const action = contracts.core.actions.approve([bob, daniel, 0]).send(bob)
+        await expectToThrow(action, 'eosio_assert: Approval limit must be a positive value.')
+    })
+
+    test('approve::error - contract disabled', async () => {
+        await contracts.core.actions.enable([false]).send()
+        const action = contracts.core.actions.approve([bob, daniel, 1]).send(bob)
+        await expectToThrow(action, ERROR_SYSTEM_DISABLED)
+    })
+
+    test('transferfrom::error - not approved', async () => {
+        const action = contracts.core.actions
+            .transferfrom([charles, [{from: bob, to: alice, droplet_ids: ['1']}], null])
+            .send(charles)
+        await expectToThrow(
+            action,
+            'eosio_assert_message: charles is not approved to transfer drops of bob.'
+        )
+    })
+
+    test('setshard::error - drops already generated', async () => {
+        const action = contracts.core.actions.setshard([2, 1]).send()
+        await expectToThrow(
+            action,
+            'eosio_assert: Shard can only be set before drops are generated.'
+        )
+    })
+
+    test('setshard::error - shard out of range', async () => {
+        const action = contracts.core.actions.setshard([1, 2]).send()
+        await expectToThrow(action, 'eosio_assert: Shard must be within the shard bits.')
+    })
+
+    test('setroute', async () => {
+        const scope = Name.from(core_contract).value.value
+        await contracts.core.actions.setroute([1, alice]).send()
+        expect(String(contracts.core.tables.route(scope).getTableRow(1n).account)).toBe(alice)
+
+        await contracts.core.actions.setroute([1, null]).send()
+        expect(contracts.core.tables.route(scope).getTableRow(1n)).toBeUndefined()
+    })
+
+    test('setshard - seeds carry the shard prefix', async () => {
+        // fresh deployment, the shard is set before any drop is generated
+        const shard = contracts.shard
+        const scope = Name.from('shard').value.value
+        await shard.actions.enable([true]).send()
+        await shard.actions.setshard([2, 1]).send()
+        await shard.actions.open([alice]).send(alice)
+        await contracts.token.actions.transfer([alice, 'shard', '1.0000 EOS', alice]).send(alice)
+
+        const data = 'shardshardshardshardshardshardsh'
+        await shard.actions.generate([alice, false, 2, data]).send(alice)
+        const seeds = shard.tables
+            .drop(scope)
+            .getTableRows()
+            .map((row) => BigInt(String(row.seed)))
+
+        // the 2 prefix bits of the seeds are replaced by the shard
+        const mask = (1n << 62n) - 1n
+        const expected = [0, 1].map((index) =>
+            (1n << 62n) | (BigInt(String(toSeed([index, index, data].join('')))) & mask)
+        )
+        expect(seeds.sort()).toEqual(expected.sort())
+        expect(seeds.every((seed) => seed >> 62n === 1n)).toBe(true)
+    })
+
+    test('shardof - routes seeds and owners', async () => {
+        const shard = contracts.shard
+        const scope = Name.from('shard').value.value
+        const accounts = [core_contract, 'shard', 'autoclose', 'eosio.token']
+        for (const [index, account] of accounts.entries()) {
+            await shard.actions.setroute([index, account]).send()
+        }
+
+        // seeds are routed by their prefix, owners by the hash of their name
+        const generated = String(shard.tables.drop(scope).getTableRows()[0].seed)
+        const other = String((3n << 62n) | 1n)
+        const hash = (BigInt(String(Name.from(alice).value)) * 0x9e3779b97f4a7c15n) % (1n << 64n)
+        await shard.actions.shardof([[generated, other], alice]).send(alice)
+        const result = getReturnValue<DropsContract.Types.shardof_return_value>(
+            DropsContract.Types.shardof_return_value
+        )
+        expect(result.seeds.map(String)).toEqual(['shard', 'eosio.token'])
+        expect(String(result.owner)).toBe(accounts[Number(hash >> 62n)])
+
+        // deployment that is not sharded routes every action to itself
+        await contracts.core.actions.shardof([[generated], alice]).send(alice)
+        const core = getReturnValue<DropsContract.Types.shardof_return_value>(
+            DropsContract.Types.shardof_return_value
+        )
+        expect(core.seeds.map(String)).toEqual([core_contract])
+        expect(String(core.owner)).toBe(core_contract)
+    })
+
+    test('transfermany - recipient listed in several entries', async () => {
+        const data = 'vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([alice, false, 2, data]).send(alice)
+        const [drop1, drop2] = [0, 1].map((index) =>
+            String(toSeed([index, sequence + index, data].join('')))
+        )
+
+        const before = getBalance(bob)
+        await contracts.core.actions
+            .transfermany([
+                alice,
+                [
+                    {to: bob, droplet_ids: [drop1]},
+                    {to: bob, droplet_ids: [drop2]},
+                ],
+                '',
+            ])
+            .send(alice)
+        expect(getBalance(bob).drops.toNumber() - before.drops.toNumber()).toBe(2)
+
+        // recipient balance is written once (single drops log)
+        const logs = blockchain.actionTraces.filter(
+            (trace) =>
+                String(trace.receiver) === core_contract &&
+                trace.decodedData?.before_drops !== undefined &&
+                String(trace.decodedData.owner) === bob
+        )
+        expect(logs.length).toBe(1)
+    })
+
+    test('airdrop - recipient listed in several entries', async () => {
+        const data = 'airdropairdropairdropairdropaird'
+        const before = getBalance(alice)
+        await contracts.core.actions
+            .airdrop([
+                bob,
+                [
+                    {to: alice, amount: 1},
+                    {to: alice, amount: 2},
+                ],
+                data,
+            ])
+            .send(bob)
+        expect(getBalance(alice).drops.toNumber() - before.drops.toNumber()).toBe(3)
+
+        // recipient balance is written once (single drops log)
+        const logs = blockchain.actionTraces.filter(
+            (trace) =>
+                String(trace.receiver) === core_contract &&
+                trace.decodedData?.before_drops !== undefined &&
+                String(trace.decodedData.owner) === alice
+        )
+        expect(logs.length).toBe(1)
+    })
+
+    test('airdrop::error - contract as owner', async () => {
+        const action = contracts.core.actions
+            .airdrop([core_contract, [{to: bob, amount: 1}], 'wwwwwwwwwwwwwwwwwwwwwwwwwwwwwwww'])
+            .send(core_contract)
+        await expectToThrow(action, 'eosio_assert: Cannot generate drops for contract.')
+    })
+
+    test('on_transfer - generate data with commas', async () => {
+        const before = getBalance(bob)
+        const data = 'xxxxxxxxxxxxxxxx,xxxxxxxxxxxxxxxx'
+        await contracts.token.actions
+            .transfer([bob, core_contract, '1.0000 EOS', `generate,${bob},1,${data}`])
+            .send(bob)
+        const after = getBalance(bob)
+        expect(after.drops.toNumber() - before.drops.toNumber()).toBe(1)
+    })
+
+    test('on_transfer::error - generate empty data', async () => {
+        const action = contracts.token.actions
+            .transfer([bob, core_contract, '1.0000 EOS', `generate,${bob},1,`])
+            .send(bob)
+        await expectToThrow(
+            action,
+            'eosio_assert: Drop data must be at least 32 characters in length.'
+        )
+    })
+
+    test('balances - legacy rows are not counted until migrated', async () => {
+        const scope = Name.from(core_contract).value.value
+        const data = 'legacylegacylegacylegacylegacyle'
+        const sequence = getState().sequence.toNumber()
+        await contracts.core.actions.generate([bob, false, 2, data]).send(bob)
+        const [drop1, drop2] = [0, 1].map((index) =>
+            String(toSeed([index, sequence + index, data].join('')))
+        )
+
+        // balances written in the layout before the counters were introduced (no extensions)
+        const balances = contracts.core.tables.balances(scope)
+        for (const owner of [bob, core_contract]) {
+            const {drops, ram_bytes} = getBalance(owner)
+            balances.set(Name.from(owner).value.value, Name.from(owner), {owner, drops, ram_bytes})
+        }
+
+        // modified rows are written back with extensions, but are not marked as migrated
+        await contracts.token.actions.transfer([bob, core_contract, '1.0000 EOS', bob]).send(bob)
+        expect(getBalance(bob).migrated).toBeFalsy()
+        expect(getBalance(core_contract).migrated).toBeFalsy()
+
+        // checksum of a legacy balance is not reported until it is recounted
+        const action = contracts.core.actions.checksum([bob]).send(bob)
+        await expectToThrow(action, 'eosio_assert: Balance has not been migrated.')
+
+        // drops of legacy balances can still be transferred and destroyed
+        await contracts.core.actions.transfer([bob, alice, [drop1], '']).send(bob)
+        await contracts.core.actions.destroy([bob, [drop2], '']).send(bob)
+        expect(getDrop(BigInt(drop1)).owner.toString()).toBe(alice)
+
+        // recounted balances are maintained again
+        await contracts.core.actions.enable([false]).send()
+        for (const owner of [bob, core_contract]) {
+            await contracts.core.actions.migrate([owner, 10000]).send()
+        }
+        await contracts.core.actions.enable([true]).send()
+        const balance = getBalance(bob)
+        expect(balance.migrated).toBeTruthy()
+        expect(balance.bound.toNumber() + balance.unbound.toNumber()).toBe(getDrops(bob).length)
+
+        // recounted checksum covers the seeds owned
+        const seeds = getDrops(bob).map((drop) => BigInt(drop.seed.toString()))
+        await contracts.core.actions.checksum([bob]).send(bob)
+        const result = getReturnValue<DropsContract.Types.checksum_return_value>(
+            DropsContract.Types.checksum_return_value
+        )
+        expect(BigInt(result.checksum.toString())).toBe(seeds.reduce((a, b) => a ^ b, 0n))
+    })
 })
@@ -30,6 +30,23 @@ void drops::transfer_ram(const name to, const int64_t bytes, const string memo)
    ramtransfer.send(get_self(), to, bytes, memo);
 }
 
+void drops::withdraw_ram_bytes(const name to, const int64_t bytes)
+{
+   // if enabled, transfer RAM bytes to receiver
+   if (FLAG_ENABLE_RAM_TRANSFER_ON_CLAIM) {
+      transfer_ram(to, bytes, MEMO_RAM_TRANSFER);
+
+      // else, sell RAM bytes and transfer EOS to receiver (0.5% fee to system contract)
+   } else {
+      // NOTE: in inventory mode, proceeds are paid from the pending EOS and the bytes return to the RAM float
+      const asset quantity = eosiosystem::ram_proceeds_minus_fee(bytes, EOS);
+      if (!debit_inventory(bytes, quantity)) {
+         sell_ram_bytes(bytes);
+      }
+      transfer_tokens(to, quantity, MEMO_RAM_SOLD_TRANSFER);
+   }
+}
+
 void drops::log_ram_bytes(const name    owner,
                           const int64_t bytes,
                           const int64_t before_ram_bytes,
@@ -42,7 +59,7 @@ void drops::log_ram_bytes(const name    owner,
 void drops::logrambytes(const name owner, const int64_t bytes, const int64_t before_ram_bytes, const int64_t ram_bytes)
 {
    require_auth(get_self());
-   notify(owner);
+   notify(owner, NOTIFY_RAM_BYTES);
 }
 
 void drops::log_drops(const name owner, const int64_t amount, const int64_t before_drops, const int64_t drops)
@@ -54,7 +71,7 @@ void drops::log_drops(const name owner, const int64_t amount, const int64_t befo
 void drops::logdrops(const name owner, const int64_t amount, const int64_t before_drops, const int64_t drops)
 {
    require_auth(get_self());
-   notify(owner);
+   notify(owner, NOTIFY_DROPS);
 }
 
 [[eosio::action]] void drops::logdestroy(const name             owner,
@@ -66,7 +83,7 @@ void drops::logdrops(const name owner, const int64_t amount, const int64_t befor
                                          const optional<name>   to_notify)
 {
    require_auth(get_self());
-   notify(owner);
+   notify(owner, NOTIFY_DESTROY);
    notify(to_notify);
 }
 
@@ -80,7 +97,7 @@ void drops::logdrops(const name owner, const int64_t amount, const int64_t befor
                                           const optional<string> memo)
 {
    require_auth(get_self());
-   notify(owner);
+   notify(owner, NOTIFY_GENERATE);
    notify(to_notify);
 }
 
@@ -48,55 +48,76 @@ asset get_fee(const asset quantity)
    return fee;
 }
 
-int64_t bytes_cost_with_fee(const asset quantity)
+ram_quote::ram_quote(symbol core_symbol) : core_symbol(core_symbol)
 {
    name      system_account = "eosio"_n;
    rammarket _rammarket(system_account, system_account.value);
 
-   const asset fee                = get_fee(quantity);
-   const asset quantity_after_fee = quantity - fee;
+   const auto& market = _rammarket.get(system_contract::ramcore_symbol.raw(), "RAM market not found.");
+   ram_reserve        = market.base.balance.amount;
+   eos_reserve        = market.quote.balance.amount;
+}
+
+asset ram_quote::cost(int64_t bytes) const
+{
+   return asset{get_bancor_input(ram_reserve, eos_reserve, bytes), core_symbol};
+}
+
+asset ram_quote::cost_with_fee(int64_t bytes) const
+{
+   const asset cost = this->cost(bytes);
+   return cost + get_fee(cost);
+}
+
+asset ram_quote::proceeds(int64_t bytes) const
+{
+   return asset{get_bancor_output(ram_reserve, eos_reserve, bytes), core_symbol};
+}
 
-   auto          itr         = _rammarket.find(system_contract::ramcore_symbol.raw());
-   const int64_t ram_reserve = itr->base.balance.amount;
-   const int64_t eos_reserve = itr->quote.balance.amount;
-   const int64_t cost        = get_bancor_output(eos_reserve, ram_reserve, quantity_after_fee.amount);
-   return cost;
+asset ram_quote::proceeds_minus_fee(int64_t bytes) const
+{
+   const asset proceeds = this->proceeds(bytes);
+   return proceeds - get_fee(proceeds);
 }
 
-asset ram_cost(uint32_t bytes, symbol core_symbol)
+int64_t ram_quote::bytes(const asset quantity) const
 {
-   name          system_account = "eosio"_n;
-   rammarket     _rammarket(system_account, system_account.value);
-   auto          itr         = _rammarket.find(system_contract::ramcore_symbol.raw());
-   const int64_t ram_reserve = itr->base.balance.amount;
-   const int64_t eos_reserve = itr->quote.balance.amount;
-   const int64_t cost        = get_bancor_input(ram_reserve, eos_reserve, bytes);
-   return asset{cost, core_symbol};
+   return get_bancor_output(eos_reserve, ram_reserve, quantity.amount);
 }
 
-asset ram_cost_with_fee(uint32_t bytes, symbol core_symbol)
+int64_t ram_quote::bytes_with_fee(const asset quantity) const { return bytes(quantity - get_fee(quantity)); }
+
+vector<asset> ram_quote::costs_with_fee(const vector<int64_t>& amounts) const
 {
-   const asset cost = ram_cost(bytes, core_symbol);
-   const asset fee  = get_fee(cost);
-   return cost + fee;
+   vector<asset> costs;
+   costs.reserve(amounts.size());
+   for (const int64_t bytes : amounts) {
+      costs.push_back(cost_with_fee(bytes));
+   }
+   return costs;
 }
 
-asset ram_proceeds(uint32_t bytes, symbol core_symbol)
+vector<int64_t> ram_quote::bytes_with_fee(const vector<asset>& quantities) const
 {
-   name          system_account = "eosio"_n;
-   rammarket     _rammarket(system_account, system_account.value);
-   auto          itr         = _rammarket.find(system_contract::ramcore_symbol.raw());
-   const int64_t ram_reserve = itr->base.balance.amount;
-   const int64_t eos_reserve = itr->quote.balance.amount;
-   const int64_t cost        = get_bancor_output(ram_reserve, eos_reserve, bytes);
-   return asset{cost, core_symbol};
+   vector<int64_t> amounts;
+   amounts.reserve(quantities.size());
+   for (const asset& quantity : quantities) {
+      amounts.push_back(bytes_with_fee(quantity));
+   }
+   return amounts;
 }
 
+int64_t bytes_cost_with_fee(const asset quantity) { return ram_quote(quantity.symbol).bytes_with_fee(quantity); }
+
+asset ram_cost(uint32_t bytes, symbol core_symbol) { return ram_quote(core_symbol).cost(bytes); }
+
+asset ram_cost_with_fee(uint32_t bytes, symbol core_symbol) { return ram_quote(core_symbol).cost_with_fee(bytes); }
+
+asset ram_proceeds(uint32_t bytes, symbol core_symbol) { return ram_quote(core_symbol).proceeds(bytes); }
+
 asset ram_proceeds_minus_fee(uint32_t bytes, symbol core_symbol)
 {
-   const asset cost = ram_proceeds(bytes, core_symbol);
-   const asset fee  = get_fee(cost);
-   return cost - fee;
+   return ram_quote(core_symbol).proceeds_minus_fee(bytes);
 }
 
 } // namespace eosiosystem
\ No newline at end of file
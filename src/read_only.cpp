@@ -7,3 +7,217 @@
 {
    return eosiosystem::bytes_cost_with_fee(quantity);
 }
+
+[[eosio::action, eosio::read_only]] dropssystem::drops::ramcurve_return_value
+dropssystem::drops::ramcurve(const vector<int64_t> bytes,
+                             const vector<asset>   quantities,
+                             const int64_t         from,
+                             const int64_t         to,
+                             const int64_t         step)
+{
+   // byte amounts with the optional range
+   vector<int64_t> amounts = bytes;
+   if (step > 0) {
+      check(from > 0 && from <= to, "Range must be positive with `from` lower or equal to `to`.");
+      check((to - from) / step < MAX_RAMCURVE_QUOTES, "Too many quotes requested.");
+      // built from an index, incrementing the amount past `to` would overflow near the int64 maximum
+      for (int64_t i = 0; i <= (to - from) / step; i++) {
+         amounts.push_back(from + i * step);
+      }
+   }
+   check(amounts.size() + quantities.size() <= MAX_RAMCURVE_QUOTES, "Too many quotes requested.");
+   for (const int64_t amount : amounts) {
+      check(amount > 0, "RAM bytes amount must be a positive value.");
+   }
+   for (const asset& quantity : quantities) {
+      check(quantity.symbol == EOS && quantity.amount > 0, "Quantity must be a positive EOS amount.");
+   }
+
+   // RAM market and bytes per drop are read once
+   const eosiosystem::ram_quote quote(EOS);
+   const int64_t                bytes_per_drop = get_bytes_per_drop();
+   const vector<asset>          costs          = quote.costs_with_fee(amounts);
+   const vector<int64_t>        purchased      = quote.bytes_with_fee(quantities);
+
+   ramcurve_return_value result;
+   result.bytes.reserve(amounts.size());
+   for (size_t i = 0; i < amounts.size(); i++) {
+      result.bytes.push_back({amounts[i], amounts[i] / bytes_per_drop, costs[i]});
+   }
+   result.quantities.reserve(quantities.size());
+   for (size_t i = 0; i < quantities.size(); i++) {
+      result.quantities.push_back({quantities[i], purchased[i], purchased[i] / bytes_per_drop});
+   }
+   return result;
+}
+
+[[eosio::action, eosio::read_only]] dropssystem::drops::ownerdrops_return_value
+dropssystem::drops::ownerdrops(const name owner, const uint32_t limit, const optional<uint64_t> cursor)
+{
+   check(limit > 0 && limit <= MAX_READ_ONLY_DROPS, "The limit must be a positive value within the maximum.");
+
+   drops::drop_table _drops(get_self(), get_self().value);
+   drops::lock_table _locks(get_self(), get_self().value);
+   auto              _drops_by_owner = _drops.get_index<"owner"_n>();
+
+   ownerdrops_return_value result;
+   result.seeds.reserve(limit);
+   result.flags.reserve(limit);
+
+   // Walk the owner's drops starting from the cursor
+   auto itr = _drops_by_owner.lower_bound(combine_ids(owner.value, cursor ? *cursor : 0));
+   while (itr != _drops_by_owner.end() && itr->owner == owner && result.seeds.size() < limit) {
+      uint8_t flags = itr->bound ? DROP_FLAG_BOUND : 0;
+      if (_locks.find(itr->seed) != _locks.end()) {
+         flags |= DROP_FLAG_LOCKED;
+      }
+      result.seeds.push_back(itr->seed);
+      result.flags.push_back(flags);
+      itr++;
+   }
+
+   // Resume from the next drop of the owner (if any)
+   if (itr != _drops_by_owner.end() && itr->owner == owner) {
+      result.next_cursor = itr->seed;
+   }
+   return result;
+}
+
+[[eosio::action, eosio::read_only]] dropssystem::drops::dropsinfo_return_value
+dropssystem::drops::dropsinfo(const vector<uint64_t> droplet_ids,
+                              const optional<name>   owner,
+                              const optional<bool>   compact)
+{
+   check(droplet_ids.size() > 0, ERROR_NO_DROPS);
+   check(droplet_ids.size() <= MAX_READ_ONLY_DROPS, "Too many drops requested.");
+
+   drops::drop_table _drops(get_self(), get_self().value);
+   drops::lock_table _locks(get_self(), get_self().value);
+
+   dropsinfo_return_value result;
+   result.valid.resize((droplet_ids.size() + 7) / 8);
+   if (!compact || !*compact) {
+      result.drops.reserve(droplet_ids.size());
+   }
+
+   for (size_t i = 0; i < droplet_ids.size(); i++) {
+      drop_info info{droplet_ids[i], name(), false, false, block_timestamp()};
+      auto      drop = _drops.find(droplet_ids[i]);
+      if (drop != _drops.end()) {
+         info.owner   = drop->owner;
+         info.bound   = drop->bound;
+         info.locked  = _locks.find(drop->seed) != _locks.end();
+         info.created = drop->created;
+
+         // valid when owned by the expected owner and transferable
+         if ((!owner || *owner == info.owner) && !info.bound && !info.locked) {
+            result.valid[i / 8] |= 1 << (i % 8);
+         }
+      }
+      if (!compact || !*compact) {
+         result.drops.push_back(info);
+      }
+   }
+   return result;
+}
+
+[[eosio::action, eosio::read_only]] dropssystem::drops::stats_return_value dropssystem::drops::stats(const name owner)
+{
+   drops::balances_table _balances(get_self(), get_self().value);
+   return {_balances.get(owner.value, ERROR_OPEN_BALANCE.c_str()),
+           _balances.get(get_self().value, ERROR_OPEN_BALANCE.c_str())};
+}
+
+[[eosio::action, eosio::read_only]] dropssystem::drops::simulate_return_value dropssystem::drops::simulate(
+   const name owner, const bool bound, const uint32_t amount, const string data, const uint32_t preview)
+{
+   // same checks as `generate`
+   check(amount > 0, "The amount of drops to generate must be a positive value.");
+   check(data.length() >= 32, "Drop data must be at least 32 characters in length.");
+   check(preview <= amount && preview <= MAX_READ_ONLY_DROPS, "Preview must be within the amount and the maximum.");
+
+   simulate_return_value result;
+   result.sequence = peek_sequence(owner, amount);
+
+   // unbound drops consume the owner's RAM bytes
+   drops::balances_table _balances(get_self(), get_self().value);
+   auto                  balance = _balances.find(owner.value);
+
+   result.bytes_required  = bound ? 0 : amount * get_bytes_per_drop();
+   result.bytes_balance   = balance != _balances.end() ? balance->ram_bytes : 0;
+   result.bytes_shortfall = std::max(result.bytes_required - result.bytes_balance, int64_t(0));
+   result.shortfall_cost  = asset{0, EOS};
+   if (result.bytes_shortfall > 0) {
+      result.shortfall_cost = eosiosystem::ram_quote(EOS).cost_with_fee(result.bytes_shortfall);
+   }
+
+   // predicted seeds and collisions against existing drops
+   drops::drop_table _drops(get_self(), get_self().value);
+   result.seeds.reserve(preview);
+   for (uint32_t i = 0; i < preview; i++) {
+      const uint64_t seed = generate_seed(i, result.sequence, data);
+      if (_drops.find(seed) != _drops.end()) {
+         result.collisions.push_back(seed);
+      }
+      result.seeds.push_back(seed);
+   }
+   return result;
+}
+
+[[eosio::action, eosio::read_only]] dropssystem::drops::changes_return_value
+dropssystem::drops::changes(const uint64_t since, const uint32_t limit)
+{
+   check(limit > 0 && limit <= MAX_READ_ONLY_DROPS, "The limit must be a positive value within the maximum.");
+
+   drops::journal_state_table _state(get_self(), get_self().value);
+   drops::journal_table       _journal(get_self(), get_self().value);
+   const auto                 state = _state.get_or_default();
+
+   // oldest change still available in the ring buffer
+   const uint64_t oldest = std::max(state.first, state.next > state.capacity ? state.next - state.capacity : 0);
+
+   changes_return_value result;
+   result.behind = since < oldest;
+   result.next   = std::max(since, oldest);
+   while (state.capacity > 0 && result.next < state.next && result.changes.size() < limit) {
+      result.changes.push_back(_journal.get(result.next % state.capacity, "Journal change not found."));
+      result.next++;
+   }
+   return result;
+}
+
+[[eosio::action, eosio::read_only]] dropssystem::drops::checksum_return_value
+dropssystem::drops::checksum(const name owner)
+{
+   drops::balances_table _balances(get_self(), get_self().value);
+   auto&                 balance = _balances.get(owner.value, ERROR_OPEN_BALANCE.c_str());
+   check(balance.migrated.value_or(false), "Balance has not been migrated.");
+   return {balance.drops, *balance.checksum};
+}
+
+[[eosio::action, eosio::read_only]] dropssystem::drops::shardof_return_value
+dropssystem::drops::shardof(const vector<uint64_t> seeds, const name owner)
+{
+   check(seeds.size() <= MAX_READ_ONLY_DROPS, "Too many drops requested.");
+
+   drops::shard_table _shard(get_self(), get_self().value);
+   drops::route_table _routes(get_self(), get_self().value);
+   const uint8_t      shard_bits = _shard.get_or_default().shard_bits;
+
+   // deployment that is not sharded routes every action to itself
+   const auto route = [&](const uint8_t shard) -> name {
+      if (shard_bits == 0) {
+         return get_self();
+      }
+      const auto itr = _routes.find(shard);
+      return itr == _routes.end() ? name() : itr->account;
+   };
+
+   shardof_return_value result;
+   result.seeds.reserve(seeds.size());
+   for (const uint64_t seed : seeds) {
+      result.seeds.push_back(route(seed_shard(seed, shard_bits)));
+   }
+   result.owner = route(owner_shard(owner, shard_bits));
+   return result;
+}
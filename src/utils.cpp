@@ -71,6 +71,43 @@ static vector<string> split(const string& str, const char delim)
    return strings;
 }
 
+/**
+ * ## STATIC `split`
+ *
+ * Split string into at most `limit` tokens, the last token holds the rest of the string (delimiters included)
+ * Empty tokens are kept
+ *
+ * ### params
+ *
+ * - `{string} str` - string to split
+ * - `{string} delim` - delimiter (ex: ",")
+ * - `{size_t} limit` - maximum amount of tokens
+ *
+ * ### returns
+ *
+ * - `{vector<string>}` - tokenized strings
+ *
+ * ### example
+ *
+ * ```c++
+ * const auto[ token0, token1 ] = utils::split( "foo,bar,baz", ",", 2 );
+ * // token0 => "foo"
+ * // token1 => "bar,baz"
+ * ```
+ */
+static vector<string> split(const string& str, const char delim, const size_t limit)
+{
+   vector<string> strings;
+   size_t         start = 0;
+   size_t         end;
+   while (strings.size() + 1 < limit && (end = str.find(delim, start)) != string::npos) {
+      strings.push_back(str.substr(start, end - start));
+      start = end + 1;
+   }
+   strings.push_back(str.substr(start));
+   return strings;
+}
+
 /**
  * ## STATIC `to_number`
  *